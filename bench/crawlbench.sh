@@ -0,0 +1,46 @@
+#! /bin/bash
+# Crawl benchmark: serves a site with tseserver and crawls it with the crawler
+# Usage: ./crawlbench.sh <tseserver options> [-- crawler options]
+#   e.g. ./crawlbench.sh -d ../test -l 20 -- -t 8
+#        DEPTH=4 ./crawlbench.sh -g 2000:8:6000 -b 1000000 -- -e 32 -k 4
+# Env: PORT (default 8080), DEPTH (crawl depth, default 2)
+# Author: Rehoboth Okorie (Oct 17 2026)
+
+PORT=${PORT:-8080}
+DEPTH=${DEPTH:-2}
+serverArgs=()
+while [[ $# -gt 0 && $1 != "--" ]]
+do
+    serverArgs+=("$1")
+    shift
+done
+shift
+crawlerArgs=("$@")
+if [[ ${#crawlerArgs[@]} == 0 ]]
+then
+    crawlerArgs=(-d 0)  # no politeness delay against a local server
+fi
+
+if [[ ! -x ./tseserver || ! -x ../crawler/crawler ]]
+then
+    echo "build tseserver and ../crawler/crawler first (make, then make -C ../crawler)"
+    exit 1
+fi
+
+out=$(mktemp -d)
+./tseserver -p "$PORT" "${serverArgs[@]}" > "$out/server.txt" &
+server=$!
+trap 'kill $server 2> /dev/null; rm -rf "$out"' EXIT
+for try in {1..50}
+do
+    [[ -s "$out/server.txt" ]] && break
+    kill -0 $server 2> /dev/null || { echo "tseserver did not start"; exit 1; }
+    sleep 0.1
+done
+seed=$(head -1 "$out/server.txt" | awk '{ print $NF }')
+mkdir "$out/pages"
+
+echo "$(head -1 "$out/server.txt")"
+echo "./crawler $seed <pageDirectory> $DEPTH ${crawlerArgs[*]} --connect 127.0.0.1:$PORT --stats"
+../crawler/crawler "$seed" "$out/pages" "$DEPTH" "${crawlerArgs[@]}" --connect "127.0.0.1:$PORT" --stats
+echo "saved $(ls "$out/pages" | grep -c '^[0-9]*$') pages"
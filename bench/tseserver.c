@@ -0,0 +1,359 @@
+/**
+ * @file tseserver.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief local http stand-in for the cs50tse server: serves a crawled pageDirectory or a synthetic link graph,
+ *        with configurable latency and bandwidth, so crawls can be benchmarked offline
+ * Usage: ./tseserver (-d pageDirectory | -g pages:fanout:bytes) [-p port] [-l latencyMs] [-b bytesPerSec] [-h host]
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L     // nanosleep, clock_gettime, strdup, strncasecmp
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "mem.h"
+#include "webpage.h"
+#include "hashtable.h"
+#include "pagedir.h"
+
+#ifndef ServerPort
+#define ServerPort 8080 // port served on unless -p is given
+#endif
+
+#ifndef ServerHost
+#define ServerHost "cs50tse.cs.dartmouth.edu" // host named in the links of a synthetic graph (one the crawler accepts)
+#endif
+
+enum { REQUEST_BUF = 16384 };       // bytes of requests buffered per connection
+static const int BACKLOG = 128;     // pending connections queued by listen
+static const int SLICES = 50;       // a throttled response is sent in slices of bytesPerSec / SLICES bytes
+
+/**
+ * @brief what to serve and how
+ *
+ */
+typedef struct serverOpts {
+    int port;                   // port to listen on
+    long latencyMs;             // delay before every response
+    long bytesPerSec;           // bandwidth of every connection, or 0 for no limit
+    const char *pageDirectory;  // crawler directory to serve, or NULL
+    int pages;                  // pages of the synthetic graph (if pageDirectory is NULL)
+    int fanout;                 // links from each synthetic page to new pages
+    int pageBytes;              // size each synthetic page is padded to
+    const char *host;           // host in the links of synthetic pages
+} server_opts_t;
+
+static server_opts_t opts;          // set once by main, read only by the connection threads
+static hashtable_t *site = NULL;    // pathname -> html of every page of pageDirectory; read only once loaded
+
+/**
+ * @brief helper function to parse args from main into opts
+ *
+ * @return int 0 if success, -1 if the arguments are invalid
+ */
+static int parseArgs(const int argc, char const *args[], server_opts_t *opts);
+
+/**
+ * @brief function to load every page of a crawler directory into site, keyed by pathname
+ *
+ * @param pageDirectory crawler directory
+ * @param seed pointer to store the url of its first page (malloc'd)
+ * @return int number of pages loaded
+ */
+static int loadSite(const char *pageDirectory, char **seed);
+
+/**
+ * @brief function to make the html of a page of the site
+ *
+ * @param pathname pathname requested
+ * @param len pointer to store the length of the html
+ * @return char* html (malloc'd) or NULL if there is no such page
+ * do
+ *  - for a pageDirectory, copy the html saved for the pathname
+ *  - for a synthetic graph, write the links of page /tse/bench/<i>.html and pad it to opts.pageBytes
+ */
+static char *pageFor(const char *pathname, size_t *len);
+
+/**
+ * @brief function run by a thread for every connection: answer its requests, in order, until it closes
+ *
+ * @param arg malloc'd int holding the socket
+ * @return void* always NULL
+ */
+static void *serveConnection(void *arg);
+
+/**
+ * @brief function to send bytes on a connection, no faster than opts.bytesPerSec
+ *
+ * @return true if every byte was sent
+ */
+static bool sendThrottled(const int fd, const char *buf, const size_t len);
+
+/**
+ * @brief function to sleep for a number of microseconds
+ *
+ */
+static void sleepMicros(const long micros);
+
+/**
+ * @brief function to read a monotonic clock in microseconds
+ *
+ */
+static long nowMicros(void);
+
+
+int main(int argc, char const *argv[]) {
+    if (parseArgs(argc, argv, &opts) != 0) {
+        fprintf(stderr, "Usage: ./tseserver (-d pageDirectory | -g pages:fanout:bytes) [-p port] [-l latencyMs] "
+                        "[-b bytesPerSec] [-h host]\n");
+        exit(-1);
+    }
+    char *seed = NULL;
+    int pages = opts.pages;
+    if (opts.pageDirectory != NULL) {
+        pages = loadSite(opts.pageDirectory, &seed);
+    } else {
+        seed = mem_malloc(strlen(opts.host) + 32);
+        if (seed != NULL) sprintf(seed, "http://%s/tse/bench/0.html", opts.host);
+    }
+    if (pages < 1 || seed == NULL) {
+        fprintf(stderr, "tseserver: nothing to serve.\n");
+        exit(-1);
+    }
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(opts.port);
+    if (sock < 0 || bind(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(sock, BACKLOG) < 0) {
+        fprintf(stderr, "tseserver: cannot listen on port %d.\n", opts.port);
+        exit(-1);
+    }
+    // the benchmark script reads the seed url from this line
+    printf("tseserver: serving %d pages on port %d, seed %s\n", pages, opts.port, seed);
+    fflush(stdout);
+    mem_free(seed);
+    for (;;) {  // a thread per connection, until killed
+        int fd = accept(sock, NULL, NULL);
+        int *arg = fd < 0 ? NULL : mem_malloc(sizeof(int));
+        pthread_t thread;
+        if (arg == NULL) {
+            if (fd >= 0) close(fd);
+            continue;
+        }
+        *arg = fd;
+        if (pthread_create(&thread, NULL, serveConnection, arg) != 0) {
+            close(fd);
+            mem_free(arg);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return 0;
+}
+
+/* helper function to parse args from main into opts */
+static int parseArgs(const int argc, char const *args[], server_opts_t *opts) {
+    opts->port = ServerPort;
+    opts->latencyMs = 0;
+    opts->bytesPerSec = 0;
+    opts->pageDirectory = NULL;
+    opts->pages = 0;
+    opts->host = ServerHost;
+    for (int i = 1; i < argc; i += 2) {    // options come in flag/value pairs
+        if (i + 1 >= argc) {
+            return -1;
+        }
+        long value = strtol(args[i + 1], NULL, 10);
+        if (strcmp(args[i], "-d") == 0 && pageDirValidate(args[i + 1])) {
+            opts->pageDirectory = args[i + 1];
+        } else if (strcmp(args[i], "-g") == 0
+                   && sscanf(args[i + 1], "%d:%d:%d", &opts->pages, &opts->fanout, &opts->pageBytes) == 3
+                   && opts->pages > 0 && opts->fanout >= 0 && opts->pageBytes >= 0) {
+            continue;
+        } else if (strcmp(args[i], "-p") == 0 && value > 0 && value <= 65535) {
+            opts->port = value;
+        } else if (strcmp(args[i], "-l") == 0 && value >= 0) {
+            opts->latencyMs = value;
+        } else if (strcmp(args[i], "-b") == 0 && value >= 0) {
+            opts->bytesPerSec = value;
+        } else if (strcmp(args[i], "-h") == 0 && args[i + 1][0] != '\0') {
+            opts->host = args[i + 1];
+        } else {
+            return -1;
+        }
+    }
+    return (opts->pageDirectory != NULL) != (opts->pages > 0) ? 0 : -1;    // exactly one site
+}
+
+/* function to load every page of a crawler directory into site, keyed by pathname */
+static int loadSite(const char *pageDirectory, char **seed) {
+    int loaded = 0;
+    webpage_t *page;
+    site = hashtable_new(1000);
+    for (int docID = 1; site != NULL && pageDirLoad(&page, pageDirectory, docID) == 1; docID++) {
+        const char *url = webpage_getURL(page);
+        const char *pathname = strstr(url, "://");
+        pathname = pathname == NULL ? NULL : strchr(pathname + 3, '/');
+        char *html = strdup(webpage_getHTML(page));
+        size_t len = html == NULL ? 0 : strlen(html);
+        if (len > 0 && html[len - 1] == '\n') {    // pageDirSave wrote it after the html
+            html[len - 1] = '\0';
+        }
+        if (pathname != NULL && html != NULL && hashtable_insert(site, pathname, html)) {
+            loaded++;
+        } else {
+            free(html);
+        }
+        if (docID == 1) {
+            *seed = strdup(url);
+        }
+        webpage_delete(page);
+    }
+    return loaded;
+}
+
+/* function to make the html of a page of the site */
+static char *pageFor(const char *pathname, size_t *len) {
+    if (site != NULL) {
+        const char *html = hashtable_find(site, pathname);
+        char *copy = html == NULL ? NULL : strdup(html);
+        if (copy != NULL) *len = strlen(copy);
+        return copy;
+    }
+    int id;
+    char end;
+    if (sscanf(pathname, "/tse/bench/%d.htm%c", &id, &end) != 2 || end != 'l' || id < 0 || id >= opts.pages) {
+        return NULL;
+    }
+    size_t linkLen = strlen(opts.host) + 64;
+    size_t cap = 128 + (opts.fanout + 2) * linkLen + opts.pageBytes;
+    char *html = malloc(cap);
+    if (html == NULL) {
+        return NULL;
+    }
+    size_t n = sprintf(html, "<html><head><title>page %d</title></head><body>\n", id);
+    for (int k = 1; k <= opts.fanout; k++) {     // children: a tree reaches every page
+        long child = (long) id * opts.fanout + k;
+        if (child < opts.pages) {
+            n += sprintf(html + n, "<a href=\"http://%s/tse/bench/%ld.html\">page %ld</a>\n", opts.host, child, child);
+        }
+    }
+    int cross = (int) (((long) id * 7919 + 13) % opts.pages);  // one link across the tree, already seen or not
+    n += sprintf(html + n, "<a href=\"http://%s/tse/bench/%d.html\">page %d</a>\n", opts.host, cross, cross);
+    if (id > 0 && opts.fanout > 0) {    // and one back up
+        int parent = (id - 1) / opts.fanout;
+        n += sprintf(html + n, "<a href=\"/tse/bench/%d.html\">up</a>\n", parent);
+    }
+    static const char *filler = "<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor.</p>\n";
+    size_t fillerLen = strlen(filler);
+    while (n + fillerLen + 16 <= (size_t) opts.pageBytes) {   // cap has room for pageBytes past the links
+        memcpy(html + n, filler, fillerLen);
+        n += fillerLen;
+    }
+    n += sprintf(html + n, "</body></html>\n");
+    *len = n;
+    return html;
+}
+
+/* function run by a thread for every connection */
+static void *serveConnection(void *arg) {
+    int fd = *(int *) arg;
+    mem_free(arg);
+    int on = 1;     // headers and body go out in separate sends: don't hold the body for the client's ack
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    char buf[REQUEST_BUF + 1];
+    size_t have = 0;
+    bool open = true;
+    while (open) {
+        char *headerEnd;
+        buf[have] = '\0';
+        while ((headerEnd = strstr(buf, "\r\n\r\n")) == NULL) {     // read up to the end of the next request
+            ssize_t n = have < REQUEST_BUF ? recv(fd, buf + have, REQUEST_BUF - have, 0) : 0;
+            if (n <= 0) {
+                close(fd);
+                return NULL;
+            }
+            have += n;
+            buf[have] = '\0';
+        }
+        char pathname[4096];
+        int minor = 1;
+        bool valid = sscanf(buf, "GET %4095s HTTP/1.%d", pathname, &minor) == 2;
+        open = valid && minor >= 1;
+        for (char *line = strstr(buf, "\r\n"); line != NULL && line < headerEnd; line = strstr(line + 2, "\r\n")) {
+            if (strncasecmp(line + 2, "Connection:", 11) == 0 && strstr(line + 13, "close") != NULL
+                && strstr(line + 13, "close") < headerEnd) {
+                open = false;
+            }
+        }
+        size_t used = headerEnd + 4 - buf;  // keep what follows: the next pipelined request
+        memmove(buf, buf + used, have - used);
+        have -= used;
+
+        sleepMicros(opts.latencyMs * 1000);
+        size_t len = 0;
+        char *html = valid ? pageFor(pathname, &len) : NULL;
+        char header[256];
+        int headerLen = html != NULL
+            ? sprintf(header, "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: %zu\r\n%s\r\n",
+                      len, open ? "" : "Connection: close\r\n")
+            : sprintf(header, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n%s\r\n", open ? "" : "Connection: close\r\n");
+        bool sent = sendThrottled(fd, header, headerLen) && (html == NULL || sendThrottled(fd, html, len));
+        free(html);
+        open = open && sent;
+    }
+    close(fd);
+    return NULL;
+}
+
+/* function to send bytes on a connection, no faster than opts.bytesPerSec */
+static bool sendThrottled(const int fd, const char *buf, const size_t len) {
+    size_t slice = opts.bytesPerSec > 0 ? opts.bytesPerSec / SLICES : len;
+    if (slice < 512) slice = 512;
+    long start = nowMicros();
+    for (size_t sent = 0; sent < len; ) {
+        size_t n = len - sent < slice ? len - sent : slice;
+        ssize_t wrote = send(fd, buf + sent, n, MSG_NOSIGNAL);
+        if (wrote <= 0) {
+            return false;
+        }
+        sent += wrote;
+        if (opts.bytesPerSec > 0) {     // wait until the bytes sent so far are due
+            sleepMicros(start + (long) (sent * 1000000.0 / opts.bytesPerSec) - nowMicros());
+        }
+    }
+    return true;
+}
+
+/* function to sleep for a number of microseconds */
+static void sleepMicros(const long micros) {
+    if (micros <= 0) {
+        return;
+    }
+    struct timespec ts = { micros / 1000000, (micros % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+/* function to read a monotonic clock in microseconds */
+static long nowMicros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
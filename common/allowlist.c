@@ -0,0 +1,257 @@
+/**
+ * @file allowlist.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in allowlist.h (an open addressing table of hosts, each with its path prefixes)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L     // strncasecmp
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include "allowlist.h"
+#include "mem.h"
+
+static const char SCHEME[] = "http://";    // the only scheme the crawler fetches
+static const int DEFAULT_PORT = 80;         // port of a url or entry that names none
+
+/**
+ * @brief an allowed host and the path prefixes allowed on it
+ *
+ */
+typedef struct allowHost {
+    uint64_t hash;      // hash of name; 0 marks an empty slot
+    char *name;         // lower case host name
+    size_t len;         // length of name
+    int port;           // port the host is allowed on
+    bool anyPath;       // true if every path on the host is allowed
+    char **prefixes;    // allowed path prefixes, each starting with '/'
+    int count;          // number of prefixes
+} allow_host_t;
+
+struct allowlist {
+    allow_host_t *table;    // hosts, by hash
+    size_t capacity;        // slots in table (a power of 2)
+    size_t hosts;           // hosts in table
+    int entries;            // entries added
+};
+
+/**
+ * @brief function to find the host of a url (or entry) and hash it in one pass
+ *
+ * @param authority start of the url after the scheme
+ * @param host pointer to store the start of the host (past any user info)
+ * @param len pointer to store the length of the host (without any port)
+ * @param port pointer to store the port (DEFAULT_PORT if none is given, -1 if it is not a number from 1 to 65535)
+ * @return const char* end of the authority: the start of the path, query or fragment, or the end of the url
+ */
+static const char *hostScan(const char *authority, const char **host, size_t *len, int *port, uint64_t *hash);
+
+/**
+ * @brief function to find the slot of a host and port: the slot holding it, or the empty slot it would go in
+ *
+ */
+static allow_host_t *hostSlot(const allowlist_t *list, const char *host, const size_t len, const int port,
+                              const uint64_t hash);
+
+/**
+ * @brief function to double the host table
+ *
+ */
+static bool allowlistGrow(allowlist_t *list);
+
+/* see allowlist.h for more information */
+allowlist_t *allowlistNew(void) {
+    allowlist_t *list = mem_calloc(1, sizeof(allowlist_t));
+    if (list == NULL) {
+        return NULL;
+    }
+    list->capacity = 16;
+    list->table = mem_calloc(list->capacity, sizeof(allow_host_t));
+    if (list->table == NULL) {
+        mem_free(list);
+        return NULL;
+    }
+    return list;
+}
+
+/* see allowlist.h for more information */
+bool allowlistAdd(allowlist_t *list, const char *entry) {
+    // validate arguments
+    if (list == NULL || entry == NULL) {
+        return false;
+    }
+    if (strncasecmp(entry, SCHEME, sizeof(SCHEME) - 1) == 0) {
+        entry += sizeof(SCHEME) - 1;
+    }
+    const char *host;
+    size_t len;
+    int port;
+    uint64_t hash;
+    const char *path = hostScan(entry, &host, &len, &port, &hash);
+    if (len == 0 || port < 0 || (*path != '\0' && *path != '/')) {
+        return false;
+    }
+    if ((list->hosts + 1) * 2 > list->capacity && !allowlistGrow(list)) {  // keep the table under half full
+        return false;
+    }
+    allow_host_t *slot = hostSlot(list, host, len, port, hash);
+    if (slot->hash == 0) {  // a new host
+        slot->name = mem_malloc(len + 1);
+        if (slot->name == NULL) {
+            return false;
+        }
+        for (size_t i = 0; i < len; i++) {
+            slot->name[i] = tolower((unsigned char) host[i]);
+        }
+        slot->name[len] = '\0';
+        slot->len = len;
+        slot->port = port;
+        slot->hash = hash;
+        list->hosts++;
+    }
+    if (*path == '\0' || strcmp(path, "/") == 0) {
+        slot->anyPath = true;
+    } else {
+        char **prefixes = realloc(slot->prefixes, (slot->count + 1) * sizeof(char *));
+        char *prefix = prefixes == NULL ? NULL : mem_malloc(strlen(path) + 1);
+        if (prefixes != NULL) {
+            slot->prefixes = prefixes;
+        }
+        if (prefix == NULL) {
+            return false;
+        }
+        strcpy(prefix, path);
+        slot->prefixes[slot->count++] = prefix;
+    }
+    list->entries++;
+    return true;
+}
+
+/* see allowlist.h for more information */
+bool allowlistMatch(const allowlist_t *list, const char *url) {
+    // validate arguments
+    if (list == NULL || url == NULL || strncmp(url, SCHEME, sizeof(SCHEME) - 1) != 0) {
+        return false;
+    }
+    const char *host;
+    size_t len;
+    int port;
+    uint64_t hash;
+    const char *path = hostScan(url + sizeof(SCHEME) - 1, &host, &len, &port, &hash);
+    if (len == 0 || port < 0) {
+        return false;
+    }
+    allow_host_t *slot = hostSlot(list, host, len, port, hash);
+    if (slot->hash == 0) {
+        return false;
+    }
+    if (slot->anyPath) {
+        return true;
+    }
+    if (*path != '/') {     // "http://host" is "http://host/"
+        path = "/";
+    }
+    for (int i = 0; i < slot->count; i++) {
+        if (strncmp(path, slot->prefixes[i], strlen(slot->prefixes[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* see allowlist.h for more information */
+int allowlistSize(const allowlist_t *list) {
+    return list == NULL ? 0 : list->entries;
+}
+
+/* see allowlist.h for more information */
+void allowlistDelete(allowlist_t *list) {
+    if (list == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < list->capacity; i++) {
+        allow_host_t *slot = &list->table[i];
+        for (int j = 0; j < slot->count; j++) {
+            mem_free(slot->prefixes[j]);
+        }
+        free(slot->prefixes);
+        mem_free(slot->name);
+    }
+    mem_free(list->table);
+    mem_free(list);
+}
+
+/* function to find the host of a url (or entry) and hash it in one pass */
+static const char *hostScan(const char *authority, const char **host, size_t *len, int *port, uint64_t *hash) {
+    uint64_t h = 0xcbf29ce484222325ULL;    // FNV-1a of the lower case host
+    const char *start = authority;
+    const char *end = NULL;     // end of the host, once a port starts
+    const char *c = authority;
+    for (; *c != '\0' && *c != '/' && *c != '?' && *c != '#'; c++) {
+        if (*c == '@') {    // what came before was user info: the host starts again
+            h = 0xcbf29ce484222325ULL;
+            start = c + 1;
+            end = NULL;
+        } else if (*c == ':' && end == NULL) {
+            end = c;
+        } else if (end == NULL) {
+            h ^= (unsigned char) tolower((unsigned char) *c);
+            h *= 0x100000001b3ULL;
+        }
+    }
+    *host = start;
+    *len = (end == NULL ? c : end) - start;
+    *port = DEFAULT_PORT;
+    if (end != NULL && c > end + 1) {   // "host:" names no port
+        long number = 0;
+        for (const char *d = end + 1; d < c && number >= 0; d++) {
+            number = isdigit((unsigned char) *d) && number <= 65535 ? number * 10 + (*d - '0') : -1;
+        }
+        *port = number >= 1 && number <= 65535 ? (int) number : -1;
+    }
+    h ^= h >> 33;
+    *hash = h == 0 ? 1 : h;
+    return c;
+}
+
+/* function to find the slot of a host */
+static allow_host_t *hostSlot(const allowlist_t *list, const char *host, const size_t len, const int port,
+                              const uint64_t hash) {
+    size_t mask = list->capacity - 1;
+    size_t i = hash & mask;
+    for (; list->table[i].hash != 0; i = (i + 1) & mask) {
+        allow_host_t *slot = &list->table[i];
+        if (slot->hash == hash && slot->len == len && slot->port == port && strncasecmp(slot->name, host, len) == 0) {
+            break;
+        }
+    }
+    return &list->table[i];
+}
+
+/* function to double the host table */
+static bool allowlistGrow(allowlist_t *list) {
+    allow_host_t *old = list->table;
+    size_t capacity = list->capacity;
+    list->table = mem_calloc(capacity * 2, sizeof(allow_host_t));
+    if (list->table == NULL) {
+        list->table = old;
+        return false;
+    }
+    list->capacity = capacity * 2;
+    for (size_t i = 0; i < capacity; i++) {
+        if (old[i].hash != 0) {
+            *hostSlot(list, old[i].name, old[i].len, old[i].port, old[i].hash) = old[i];
+        }
+    }
+    mem_free(old);
+    return true;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file allowlist.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief allowlist provides the set of hosts (and path prefixes on them) a crawl may follow links to
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __ALLOW_LIST_H_
+#define __ALLOW_LIST_H_
+#include <stdbool.h>
+
+/**
+ * @brief opaque type holding a table of allowed hosts, each with its allowed path prefixes
+ *
+ */
+typedef struct allowlist allowlist_t;
+
+/**
+ * @brief function to make a new, empty allowlist (which allows nothing)
+ *
+ * @return allowlist_t* new allowlist or NULL on failure
+ */
+allowlist_t *allowlistNew(void);
+
+/**
+ * @brief function to allow a host, or a path prefix on a host
+ *
+ * @param list allowlist
+ * @param entry "host" (every path), "host/prefix" or "http://host/prefix", e.g. "cs50tse.cs.dartmouth.edu/tse/";
+ *              the host may have a port ("localhost:8080"), 80 if it has none
+ * @return true if the entry was added
+ * @return false if list or entry is NULL, the entry has no host, its port is not a number or memory ran out
+ * do
+ *  - lower case the host, as normalizeURL does
+ *  - a prefix is matched as given, so "host/tse" also allows "host/tsetse.html" where "host/tse/" does not
+ */
+bool allowlistAdd(allowlist_t *list, const char *entry);
+
+/**
+ * @brief function to check whether a normalized url is allowed
+ *
+ * @param list allowlist
+ * @param url normalized absolute url (from normalizeURL)
+ * @return true if the url is http, its host is in the list on the url's port (80 if it gives none)
+ *         and its path starts with one of the host's prefixes
+ * one pass over the host hashes it, so a check costs one probe of the host table and no allocation; needs no lock
+ */
+bool allowlistMatch(const allowlist_t *list, const char *url);
+
+/**
+ * @brief function to get the number of entries added
+ *
+ */
+int allowlistSize(const allowlist_t *list);
+
+/**
+ * @brief function to delete an allowlist
+ *
+ * @param list allowlist (may be NULL)
+ */
+void allowlistDelete(allowlist_t *list);
+
+#endif
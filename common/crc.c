@@ -0,0 +1,30 @@
+/**
+ * @file crc.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in crc.h (CRC-32)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crc.h"
+
+/* see crc.h for more information */
+uint32_t crc32(uint32_t crc, const void *data, const size_t len) {
+    static const uint32_t TABLE[16] = {     // crc of each 4 bit value, reflected polynomial 0xedb88320
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    const unsigned char *bytes = data;
+    crc ^= 0xffffffff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ TABLE[crc & 15];
+        crc = (crc >> 4) ^ TABLE[crc & 15];
+    }
+    return crc ^ 0xffffffff;
+}
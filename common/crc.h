@@ -0,0 +1,27 @@
+/**
+ * @file crc.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief crc provides the CRC-32 shared by the binary index file and the gzip decoder
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __CRC_H_
+#define __CRC_H_
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief function to update a CRC-32 (reflected polynomial 0xedb88320, as gzip uses it) with more data
+ *
+ * @param crc crc of the data before, or 0 to start
+ * @param data bytes to add
+ * @param len number of bytes
+ * @return uint32_t crc of the data so far
+ */
+uint32_t crc32(uint32_t crc, const void *data, const size_t len);
+
+#endif
@@ -0,0 +1,613 @@
+/**
+ * @file evfetch.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in evfetch.h (an event driven page fetcher built on non-blocking sockets and epoll)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _GNU_SOURCE     // SOCK_NONBLOCK, strdup, strncasecmp
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include "evfetch.h"
+#include "http.h"
+#include "httpbody.h"
+#include "fetchstats.h"
+#include "hostsched.h"
+#include "webpage.h"
+#include "hashtable.h"
+#include "mem.h"
+
+#ifndef EvfetchTimeout
+#define EvfetchTimeout 30 // seconds a request may stay in flight before it is retried
+#endif
+
+#ifndef EvfetchRetryMs
+#define EvfetchRetryMs 100 // milliseconds a failed attempt waits before it is retried, doubled for each later attempt
+#endif
+
+static const int MAX_TRY = 3;       // maximum attempts per request
+static const int MAX_EVENTS = 64;   // events handled per epoll_wait
+static const int READ_CHUNK = 16384;    // bytes read per recv
+enum { MAX_CODING = 32 };           // longest Content-Encoding value kept
+
+/**
+ * @brief what an in flight request is waiting for
+ *
+ */
+typedef enum reqState { CONNECTING, SENDING, RECEIVING } req_state_t;
+
+/**
+ * @brief resolved address of a host and its name in the scheduler
+ *
+ */
+typedef struct evhost {
+    struct sockaddr_in addr;    // address to connect to
+    bool resolved;              // false if the lookup failed
+    char *hostname;             // key of the host in the scheduler
+} evhost_t;
+
+/**
+ * @brief one request and its buffers
+ *
+ */
+typedef struct evreq {
+    webpage_t *page;        // page being fetched
+    evhost_t *host;         // host of the page
+    int fd;                 // socket or -1
+    req_state_t state;      // what the socket is waiting for
+    int tries;              // connection attempts so far
+    bool claimed;           // true while the request holds a scheduler slot
+    http_validators_t *validators;  // validators of the stored copy, refreshed from the response (not owned), or NULL
+    char *out;              // request text
+    size_t outLen;          // length of the request text
+    size_t outSent;         // bytes of the request sent so far
+    char *in;               // headers, then chunk framing, read but not yet parsed
+    size_t inLen;           // bytes in in
+    size_t inUsed;          // bytes of in already parsed
+    size_t inScanned;       // bytes of in already searched for the blank line that ends the headers
+    size_t inCap;           // capacity of in
+    size_t received;        // bytes received over every attempt, for fetchstats
+    long startedAt;         // fetchstatsClock when the first attempt started
+    httpbody_t *body;       // reader of the body once the headers of a 200 are read, or NULL
+    char encoding[MAX_CODING];      // Content-Encoding of the response
+    http_validators_t fresh;        // ETag and Last-Modified of a 200, moved to validators once its body is whole
+    time_t deadline;        // time after which the attempt is abandoned
+    long retryAt;           // fetchstatsClock before which a failed request may not start again, or 0
+    int slot;               // index in the active array
+    struct evreq *next;     // next request in the waiting or done list
+} evreq_t;
+
+/**
+ * @brief fetcher state
+ *
+ */
+struct evfetch {
+    int epfd;               // epoll instance
+    int maxInFlight;        // size of active
+    hostsched_t *sched;     // per-host politeness (shared, not owned)
+    long wakeMs;            // milliseconds until a delayed waiting request may start, or -1
+    evreq_t **active;       // requests in flight
+    int nActive;            // number of requests in flight
+    evreq_t *waitHead;      // requests waiting for a slot (FIFO)
+    evreq_t *waitTail;
+    evreq_t *doneHead;      // completed requests not yet returned (FIFO)
+    evreq_t *doneTail;
+    int pending;            // requests added and not yet returned
+    hashtable_t *hosts;     // hostname -> evhost_t
+};
+
+static void listPush(evreq_t **head, evreq_t **tail, evreq_t *req);
+static evhost_t *hostLookup(evfetch_t *ev, const char *hostname, const int port);
+static void startWaiting(evfetch_t *ev);
+static bool startRequest(evfetch_t *ev, evreq_t *req);
+static void closeRequest(evfetch_t *ev, evreq_t *req);
+static void retryRequest(evfetch_t *ev, evreq_t *req);
+static void finishRequest(evfetch_t *ev, evreq_t *req, char *html);
+static void handleEvent(evfetch_t *ev, evreq_t *req, const unsigned int events);
+static bool sendRequest(evfetch_t *ev, evreq_t *req);
+static void receiveResponse(evfetch_t *ev, evreq_t *req);
+static int responseParse(evreq_t *req);
+static int responseHeaders(evreq_t *req, const char *headerEnd);
+static char *responseBody(evreq_t *req);
+static void expireRequests(evfetch_t *ev);
+static void freeRequest(evreq_t *req);
+static void freeList(evreq_t *req);
+static void hostFree(void *item);
+
+/* function to make a new event driven fetcher */
+/* see evfetch.h for more information */
+evfetch_t *evfetchNew(const int maxInFlight, hostsched_t *sched) {
+    if (maxInFlight < 1 || sched == NULL) {   // validate arguments
+        return NULL;
+    }
+    evfetch_t *ev = mem_calloc(1, sizeof(evfetch_t));
+    if (ev == NULL) {
+        return NULL;
+    }
+    ev->active = mem_calloc(maxInFlight, sizeof(evreq_t *));
+    ev->hosts = hashtable_new(31);
+    ev->epfd = epoll_create1(0);
+    if (ev->active == NULL || ev->hosts == NULL || ev->epfd < 0) {
+        if (ev->epfd >= 0) close(ev->epfd);
+        if (ev->hosts != NULL) hashtable_delete(ev->hosts, NULL);
+        mem_free(ev->active);
+        mem_free(ev);
+        return NULL;
+    }
+    ev->maxInFlight = maxInFlight;
+    ev->sched = sched;
+    ev->wakeMs = -1;
+    return ev;
+}
+
+/* function to queue a page to be fetched */
+/* see evfetch.h for more information */
+bool evfetchAdd(evfetch_t *ev, webpage_t *page, http_validators_t *validators) {
+    if (ev == NULL || page == NULL || webpage_getURL(page) == NULL || webpage_getHTML(page) != NULL) {
+        return false;
+    }
+    evreq_t *req = mem_calloc(1, sizeof(evreq_t));
+    if (req == NULL) {
+        return false;
+    }
+    req->page = page;
+    req->validators = validators;
+    req->fd = -1;
+    req->slot = -1;
+    ev->pending++;
+
+    char *hostname, *pathname;
+    int port;
+    if (!httpBurstURL(webpage_getURL(page), &hostname, &port, &pathname)) {   // cannot be fetched
+        finishRequest(ev, req, NULL);
+        return true;
+    }
+    req->host = hostLookup(ev, hostname, port);
+    int condLen = httpValidatorsFormat(validators, NULL, 0);
+    char conditional[condLen + 1];  // If-None-Match and If-Modified-Since, if validators are set
+    httpValidatorsFormat(validators, conditional, condLen + 1);
+    const char *format = "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\nAccept-Encoding: gzip, deflate\r\n%s\r\n";
+    int len = snprintf(NULL, 0, format, pathname, hostname, conditional);
+    req->out = mem_malloc(len + 1);
+    if (req->out != NULL) {
+        snprintf(req->out, len + 1, format, pathname, hostname, conditional);
+        req->outLen = len;
+    }
+    mem_free(hostname);
+    mem_free(pathname);
+    if (req->host == NULL || !req->host->resolved || req->out == NULL) {
+        finishRequest(ev, req, NULL);
+        return true;
+    }
+    listPush(&ev->waitHead, &ev->waitTail, req);
+    startWaiting(ev);
+    return true;
+}
+
+/* function to wait for the next request to complete */
+/* see evfetch.h for more information */
+webpage_t *evfetchNext(evfetch_t *ev, http_validators_t **validators) {
+    if (ev == NULL) {
+        return NULL;
+    }
+    struct epoll_event events[MAX_EVENTS];
+    while (ev->doneHead == NULL && (ev->nActive > 0 || ev->waitHead != NULL)) {  // run the loop until something completes
+        startWaiting(ev);
+        if (ev->doneHead != NULL) {     // a request failed to start
+            break;
+        }
+        int timeout = ev->wakeMs >= 0 && ev->wakeMs < 1000 ? (int) ev->wakeMs : 1000;  // wake for the next host that allows a fetch
+        int n = epoll_wait(ev->epfd, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            handleEvent(ev, (evreq_t *) events[i].data.ptr, events[i].events);
+        }
+        expireRequests(ev);
+    }
+    evreq_t *req = ev->doneHead;
+    if (req == NULL) {
+        return NULL;
+    }
+    ev->doneHead = req->next;
+    if (ev->doneHead == NULL) {
+        ev->doneTail = NULL;
+    }
+    ev->pending--;
+    if (validators != NULL) {
+        *validators = req->validators;
+    }
+    webpage_t *page = req->page;
+    req->page = NULL;
+    freeRequest(req);
+    return page;
+}
+
+/* function to get the number of requests queued, in flight or completed but not yet returned */
+/* see evfetch.h for more information */
+int evfetchPending(evfetch_t *ev) {
+    return ev == NULL ? 0 : ev->pending;
+}
+
+/* function to delete a fetcher, its sockets and any pages it still holds */
+/* see evfetch.h for more information */
+void evfetchDelete(evfetch_t *ev) {
+    if (ev == NULL) {
+        return;
+    }
+    while (ev->nActive > 0) {
+        evreq_t *req = ev->active[0];
+        closeRequest(ev, req);
+        freeRequest(req);
+    }
+    freeList(ev->waitHead);
+    freeList(ev->doneHead);
+    close(ev->epfd);
+    hashtable_delete(ev->hosts, hostFree);
+    mem_free(ev->active);
+    mem_free(ev);
+}
+
+/* function to append a request to a FIFO list */
+static void listPush(evreq_t **head, evreq_t **tail, evreq_t *req) {
+    req->next = NULL;
+    if (*tail == NULL) {
+        *head = req;
+    } else {
+        (*tail)->next = req;
+    }
+    *tail = req;
+}
+
+/* function to find or resolve a host; the lookup is done once per host */
+static evhost_t *hostLookup(evfetch_t *ev, const char *hostname, const int port) {
+    char key[strlen(hostname) + 16];
+    sprintf(key, "%s:%d", hostname, port);
+    evhost_t *host = hashtable_find(ev->hosts, key);
+    if (host != NULL) {
+        return host;
+    }
+    host = mem_calloc(1, sizeof(evhost_t));
+    if (host == NULL) {
+        return NULL;
+    }
+    host->hostname = mem_malloc(strlen(hostname) + 1);
+    if (host->hostname == NULL) {
+        mem_free(host);
+        return NULL;
+    }
+    strcpy(host->hostname, hostname);
+    host->resolved = httpResolve(hostname, port, &host->addr);
+    hashtable_insert(ev->hosts, key, host);
+    return host;
+}
+
+/* function to start waiting requests while there are free slots for them and their hosts allow a fetch */
+static void startWaiting(evfetch_t *ev) {
+    evreq_t *prev = NULL;
+    ev->wakeMs = -1;
+    long now = fetchstatsClock();
+    for (evreq_t *req = ev->waitHead; req != NULL && ev->nActive < ev->maxInFlight; ) {
+        evreq_t *next = req->next;
+        long wait = req->retryAt > now ? (req->retryAt - now + 999) / 1000   // a failed request backs off first
+                                       : hostschedTryAcquire(ev->sched, req->host->hostname, 1);
+        if (wait > 0 && (ev->wakeMs < 0 || wait < ev->wakeMs)) {  // remember the soonest a delayed host frees up
+            ev->wakeMs = wait;
+        }
+        if (wait == 0) {  // unlink and start it
+            req->claimed = true;
+            if (prev == NULL) {
+                ev->waitHead = next;
+            } else {
+                prev->next = next;
+            }
+            if (ev->waitTail == req) {
+                ev->waitTail = prev;
+            }
+            req->next = NULL;
+            if (!startRequest(ev, req)) {   // requeued at the tail, not to start again in this pass
+                retryRequest(ev, req);
+            }
+        } else {
+            prev = req;
+        }
+        req = next;
+    }
+}
+
+/* function to open a non-blocking connection for a request and register it with epoll */
+static bool startRequest(evfetch_t *ev, evreq_t *req) {
+    if (req->tries++ == 0) {
+        req->startedAt = fetchstatsClock();
+    }
+    req->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (req->fd < 0) {
+        return false;
+    }
+    req->slot = ev->nActive;
+    ev->active[ev->nActive++] = req;
+    req->state = CONNECTING;
+    req->outSent = 0;
+    req->inLen = req->inUsed = req->inScanned = 0;
+    httpBodyDelete(req->body);  // forget what an earlier attempt read
+    req->body = NULL;
+    req->encoding[0] = '\0';
+    httpValidatorsClear(&req->fresh);
+    req->deadline = time(NULL) + EvfetchTimeout;
+    if (connect(req->fd, (struct sockaddr *) &req->host->addr, sizeof(req->host->addr)) < 0 && errno != EINPROGRESS) {
+        return false;
+    }
+    struct epoll_event event;
+    event.events = EPOLLOUT;
+    event.data.ptr = req;
+    return epoll_ctl(ev->epfd, EPOLL_CTL_ADD, req->fd, &event) == 0;
+}
+
+/* function to close the socket of a request and give up its slot */
+static void closeRequest(evfetch_t *ev, evreq_t *req) {
+    if (req->fd >= 0) {
+        epoll_ctl(ev->epfd, EPOLL_CTL_DEL, req->fd, NULL);
+        close(req->fd);
+        req->fd = -1;
+    }
+    if (req->slot >= 0) {   // swap the last active request into this slot
+        evreq_t *last = ev->active[--ev->nActive];
+        ev->active[req->slot] = last;
+        last->slot = req->slot;
+        req->slot = -1;
+    }
+    if (req->claimed) {     // let the next request to the host start
+        hostschedRelease(ev->sched, req->host->hostname);
+        req->claimed = false;
+    }
+}
+
+/* function to retry a failed attempt, or fail the request after MAX_TRY attempts */
+static void retryRequest(evfetch_t *ev, evreq_t *req) {
+    closeRequest(ev, req);
+    if (req->tries >= MAX_TRY) {
+        finishRequest(ev, req, NULL);
+        return;
+    }
+    // wait before the next attempt, so a failure that happens at once (say socket() out of descriptors)
+    // does not use up every try in one pass of startWaiting
+    req->retryAt = fetchstatsClock() + (long) EvfetchRetryMs * 1000 * (1L << (req->tries - 1));
+    listPush(&ev->waitHead, &ev->waitTail, req);
+}
+
+/* function to complete a request; html is NULL if the fetch failed */
+static void finishRequest(evfetch_t *ev, evreq_t *req, char *html) {
+    closeRequest(ev, req);
+    if (req->tries > 0) {   // timed from the first attempt, so retries count
+        fetchstatsRecord(fetchstatsClock() - req->startedAt, req->received,
+                         html != NULL || (req->validators != NULL && req->validators->notModified));
+    }
+    if (html != NULL) {     // swap in a page holding the html
+        char *url = strdup(webpage_getURL(req->page));
+        webpage_t *page = url == NULL ? NULL : webpage_new(url, webpage_getDepth(req->page), html);
+        if (page == NULL) {
+            free(url);
+            free(html);
+        } else {
+            webpage_delete(req->page);
+            req->page = page;
+        }
+    }
+    listPush(&ev->doneHead, &ev->doneTail, req);
+}
+
+/* function to advance a request on an epoll event */
+static void handleEvent(evfetch_t *ev, evreq_t *req, const unsigned int events) {
+    if (req->state == CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if ((events & EPOLLERR) || getsockopt(req->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+            retryRequest(ev, req);
+            startWaiting(ev);
+            return;
+        }
+        req->state = SENDING;
+    }
+    if (req->state == SENDING) {
+        if (!sendRequest(ev, req)) {
+            retryRequest(ev, req);
+            startWaiting(ev);
+        }
+        return;
+    }
+    receiveResponse(ev, req);
+}
+
+/* function to send as much of the request as the socket accepts */
+static bool sendRequest(evfetch_t *ev, evreq_t *req) {
+    while (req->outSent < req->outLen) {
+        ssize_t n = send(req->fd, req->out + req->outSent, req->outLen - req->outSent, MSG_NOSIGNAL);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;    // wait for the next EPOLLOUT
+        }
+        req->outSent += n;
+    }
+    struct epoll_event event;   // request sent: wait for the response
+    event.events = EPOLLIN;
+    event.data.ptr = req;
+    req->state = RECEIVING;
+    return epoll_ctl(ev->epfd, EPOLL_CTL_MOD, req->fd, &event) == 0;
+}
+
+/* function to read what the socket has and complete the request once the response is whole */
+static void receiveResponse(evfetch_t *ev, evreq_t *req) {
+    int status = 0;
+    while (status == 0) {
+        size_t room;
+        char *space = req->body == NULL ? NULL : httpBodySpace(req->body, &room);
+        bool direct = space != NULL;    // body data goes straight into the body
+        if (!direct) {  // headers or chunk framing: read into in
+            if (req->inCap - req->inLen < READ_CHUNK) {  // make room for another read
+                char *in = realloc(req->in, req->inCap + READ_CHUNK + 1);
+                if (in == NULL) {
+                    status = -1;
+                    break;
+                }
+                req->in = in;
+                req->inCap += READ_CHUNK;
+            }
+            space = req->in + req->inLen;
+            room = req->inCap - req->inLen;
+        }
+        ssize_t n = recv(req->fd, space, room, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (n < 0) {
+            retryRequest(ev, req);
+            startWaiting(ev);
+            return;
+        } else if (n == 0) {    // whole only if the body ends with the connection
+            status = req->body != NULL && httpBodyEnd(req->body) ? 1 : -1;
+            break;
+        }
+        req->received += n;
+        if (direct) {
+            httpBodyCommit(req->body, n);
+            status = httpBodyStatus(req->body);
+        } else {
+            req->inLen += n;
+            status = responseParse(req);
+        }
+    }
+    if (status != 0) {
+        finishRequest(ev, req, status == 1 ? responseBody(req) : NULL);
+        startWaiting(ev);
+    }
+}
+
+/* function to parse the bytes read into in: the headers, then the body bytes and chunk framing after them */
+/* returns 1 once the response is whole (a 304 is once its headers are), 0 if more is needed, -1 on failure */
+static int responseParse(evreq_t *req) {
+    req->in[req->inLen] = '\0';
+    if (req->body == NULL) {
+        char *headerEnd = NULL;
+        size_t sepLen = 0;
+        char *end = req->in + req->inLen;
+        char *nl = memchr(req->in + req->inScanned, '\n', end - (req->in + req->inScanned));
+        for (; nl != NULL && headerEnd == NULL; nl = memchr(nl + 1, '\n', end - (nl + 1))) {
+            if (nl + 1 == end || (nl[1] == '\r' && nl + 2 == end)) {   // cannot tell yet: look again next read
+                break;
+            } else if (nl[1] == '\n') {
+                headerEnd = nl;
+                sepLen = 2;
+            } else if (nl > req->in && nl[-1] == '\r' && nl[1] == '\r' && nl[2] == '\n') {
+                headerEnd = nl - 1;
+                sepLen = 4;
+            }
+        }
+        if (headerEnd == NULL) {    // headers not complete: only search what arrives from here on
+            req->inScanned = nl != NULL ? (size_t) (nl - req->in) : req->inLen;
+            return 0;
+        }
+        int status = responseHeaders(req, headerEnd);
+        if (status != 0) {
+            return status;
+        }
+        req->inUsed = headerEnd + sepLen - req->in;
+    }
+    req->inUsed += httpBodyFeed(req->body, req->in + req->inUsed, req->inLen - req->inUsed);
+    if (req->inUsed == req->inLen) {    // everything read is parsed: reuse the buffer
+        req->inLen = req->inUsed = 0;
+    }
+    return httpBodyStatus(req->body);
+}
+
+/* function to read the status and headers of a response and start the reader of a 200 body */
+/* a 304 to a conditional request only updates the validators it repeats and sets notModified */
+static int responseHeaders(evreq_t *req, const char *headerEnd) {
+    int code = 0;
+    if (sscanf(req->in, "HTTP/1.%*d %d", &code) != 1 || (code != 200 && (code != 304 || req->validators == NULL))) {
+        return -1;
+    }
+    http_validators_t *target = code == 304 ? req->validators : &req->fresh;
+    long contentLength = -1;
+    bool chunked = false;
+    for (char *line = strchr(req->in, '\n'); line != NULL && line < headerEnd; line = strchr(line + 1, '\n')) {
+        if (strncasecmp(line + 1, "Content-Length:", 15) == 0) {
+            contentLength = strtol(line + 16, NULL, 10);
+        } else if (strncasecmp(line + 1, "Transfer-Encoding:", 18) == 0) {
+            chunked = strncasecmp(line + 19 + strspn(line + 19, " \t"), "chunked", 7) == 0;
+        } else if (strncasecmp(line + 1, "Content-Encoding:", 17) == 0) {
+            snprintf(req->encoding, sizeof(req->encoding), "%.*s", (int) strcspn(line + 18, "\r\n"), line + 18);
+        } else {
+            httpValidatorsParse(target, line + 1);    // stops at the line's \r or \n
+        }
+    }
+    if (code == 304) {
+        req->validators->notModified = true;
+        return 1;
+    }
+    req->body = httpBodyNew(contentLength, chunked);
+    return req->body == NULL ? -1 : 0;
+}
+
+/* function to take the html of a whole 200 response, decoded; NULL for a 304 or if it cannot be decoded */
+static char *responseBody(evreq_t *req) {
+    size_t len;
+    char *html = httpBodyTake(req->body, &len);
+    if (html != NULL && req->encoding[0] != '\0') {
+        html = httpDecodeBody(req->encoding, html, &len);  // gzip or deflate, as the request offered
+    }
+    if (html != NULL && req->validators != NULL) {   // the copy the caller keeps now matches these
+        httpValidatorsClear(req->validators);
+        *req->validators = req->fresh;
+        memset(&req->fresh, 0, sizeof(req->fresh));
+    }
+    return html;
+}
+
+/* function to retry requests that have been in flight for longer than EvfetchTimeout */
+static void expireRequests(evfetch_t *ev) {
+    time_t now = time(NULL);
+    for (int i = ev->nActive - 1; i >= 0; i--) {
+        if (i < ev->nActive && ev->active[i]->deadline < now) {
+            retryRequest(ev, ev->active[i]);
+        }
+    }
+    startWaiting(ev);
+}
+
+/* function to free a request and the page it still holds */
+static void freeRequest(evreq_t *req) {
+    if (req->page != NULL) webpage_delete(req->page);
+    mem_free(req->out);
+    free(req->in);
+    httpBodyDelete(req->body);
+    httpValidatorsClear(&req->fresh);
+    mem_free(req);
+}
+
+/* function to free every request in a list */
+static void freeList(evreq_t *req) {
+    while (req != NULL) {
+        evreq_t *next = req->next;
+        freeRequest(req);
+        req = next;
+    }
+}
+
+/* function to free a host entry */
+static void hostFree(void *item) {
+    evhost_t *host = item;
+    mem_free(host->hostname);
+    mem_free(host);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file evfetch.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief evfetch provides an event driven page fetcher that keeps many requests in flight from a single thread
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __EVFETCH_H_
+#define __EVFETCH_H_
+#include <stdbool.h>
+#include <webpage.h>
+#include "hostsched.h"
+#include "http.h"
+
+/**
+ * @brief opaque type holding the epoll instance, the requests in flight and the requests waiting for a slot
+ *
+ */
+typedef struct evfetch evfetch_t;
+
+/**
+ * @brief function to make a new event driven fetcher
+ *
+ * @param maxInFlight number of requests allowed in flight at once
+ * @param sched per-host politeness scheduler deciding when a request to a host may start; not owned by the fetcher
+ * @return evfetch_t* new fetcher or NULL on failure
+ */
+evfetch_t *evfetchNew(const int maxInFlight, hostsched_t *sched);
+
+/**
+ * @brief function to queue a page to be fetched
+ *
+ * @param ev fetcher
+ * @param page webpage with a url and no html; the fetcher takes ownership of it
+ * @param validators validators of a stored copy of the page to make the request conditional (as in
+ *  httpFetchAllConditional), or NULL; not owned, must outlive the request, and is refreshed from the response
+ * @return true if the page was queued
+ * @return false if an argument is invalid (the caller keeps the page)
+ * do
+ *  - start the request right away if there is a free slot for it, otherwise queue it
+ */
+bool evfetchAdd(evfetch_t *ev, webpage_t *page, http_validators_t *validators);
+
+/**
+ * @brief function to wait for the next request to complete
+ *
+ * @param ev fetcher
+ * @param validators pointer to store the validators given to evfetchAdd with the page (may be NULL)
+ * @return webpage_t* the page of the completed request, or NULL if no request is queued or in flight
+ *         or if waiting for events failed (evfetchPending is then still above 0)
+ * do
+ *  - run the event loop (connect, send, receive) until a request completes
+ *  - the returned page has html if the fetch succeeded and NULL html if it failed
+ *    (or if its validators have notModified set)
+ *  - the caller owns the returned page and must webpage_delete it
+ */
+webpage_t *evfetchNext(evfetch_t *ev, http_validators_t **validators);
+
+/**
+ * @brief function to get the number of requests queued, in flight or completed but not yet returned
+ *
+ * @param ev fetcher
+ * @return int number of pending requests
+ */
+int evfetchPending(evfetch_t *ev);
+
+/**
+ * @brief function to delete a fetcher, its sockets and any pages it still holds
+ *
+ * @param ev fetcher to delete
+ */
+void evfetchDelete(evfetch_t *ev);
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file fetchstats.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in fetchstats.h (latency and size of every fetch, for benchmarking a crawl)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L     // clock_gettime
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "fetchstats.h"
+
+enum { SUB_BITS = 5 };              // 32 buckets per power of two: a bucket is at most 1/32 of its value wide
+enum { LINEAR = 64 };               // latencies under this many microseconds each have their own bucket
+enum { BUCKETS = LINEAR + 40 * (1 << SUB_BITS) };   // up to 2^46 microseconds
+
+/**
+ * @brief fetches recorded so far; a latency histogram keeps the memory fixed however long the crawl
+ *
+ */
+static struct {
+    bool enabled;               // true once fetchstatsEnable is called
+    long fetched;               // fetches that got a 200 or 304
+    long failed;                // fetches that did not
+    long long bytes;            // bytes received
+    long histogram[BUCKETS];    // fetches by latency bucket
+} stats;
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;    // guards stats
+
+/**
+ * @brief function to find the histogram bucket of a latency
+ *
+ * @param micros latency in microseconds
+ * @return int bucket index
+ */
+static int bucketOf(long micros);
+
+/**
+ * @brief function to find the latency in the middle of a histogram bucket
+ *
+ * @param bucket bucket index
+ * @return double latency in microseconds
+ */
+static double bucketValue(const int bucket);
+
+/* see fetchstats.h for more information */
+void fetchstatsEnable(void) {
+    pthread_mutex_lock(&statsLock);
+    memset(&stats, 0, sizeof(stats));
+    stats.enabled = true;
+    pthread_mutex_unlock(&statsLock);
+}
+
+/* see fetchstats.h for more information */
+long fetchstatsClock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+/* see fetchstats.h for more information */
+void fetchstatsRecord(const long micros, const size_t bytes, const bool ok) {
+    if (!stats.enabled) {   // set before the fetchers start, so reading it unlocked is safe
+        return;
+    }
+    int bucket = bucketOf(micros);
+    pthread_mutex_lock(&statsLock);
+    if (ok) {
+        stats.fetched++;
+    } else {
+        stats.failed++;
+    }
+    stats.bytes += bytes;
+    stats.histogram[bucket]++;
+    pthread_mutex_unlock(&statsLock);
+}
+
+/* see fetchstats.h for more information */
+double fetchstatsPercentile(const double p) {
+    pthread_mutex_lock(&statsLock);
+    long total = stats.fetched + stats.failed;
+    double value = 0;
+    if (total > 0) {
+        long rank = (long) (p / 100 * total + 0.5);     // fetches at or under the percentile
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+        long seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += stats.histogram[i];
+            if (seen >= rank) {
+                value = bucketValue(i) / 1000;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&statsLock);
+    return value;
+}
+
+/* see fetchstats.h for more information */
+void fetchstatsReport(FILE *fp, const double seconds) {
+    // validate arguments
+    if (fp == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&statsLock);
+    long fetched = stats.fetched, failed = stats.failed;
+    long long bytes = stats.bytes;
+    pthread_mutex_unlock(&statsLock);
+    double rate = seconds > 0 ? 1 / seconds : 0;
+    fprintf(fp, "fetched %ld pages (%ld failed), %lld bytes in %.3f s\n", fetched, failed, bytes, seconds);
+    fprintf(fp, "throughput %.1f pages/s, %.0f bytes/s\n", fetched * rate, bytes * rate);
+    fprintf(fp, "fetch latency p50 %.2f ms, p90 %.2f ms, p99 %.2f ms\n",
+            fetchstatsPercentile(50), fetchstatsPercentile(90), fetchstatsPercentile(99));
+}
+
+/* function to find the histogram bucket of a latency */
+static int bucketOf(long micros) {
+    if (micros < LINEAR) {
+        return micros < 0 ? 0 : (int) micros;
+    }
+    int msb = 0;    // highest set bit
+    while ((micros >> (msb + 1)) != 0) {
+        msb++;
+    }
+    int bucket = LINEAR + (msb - 6) * (1 << SUB_BITS) + (int) ((micros >> (msb - SUB_BITS)) & ((1 << SUB_BITS) - 1));
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+/* function to find the latency in the middle of a histogram bucket */
+static double bucketValue(const int bucket) {
+    if (bucket < LINEAR) {
+        return bucket;
+    }
+    int msb = (bucket - LINEAR) / (1 << SUB_BITS) + 6;
+    int sub = (bucket - LINEAR) % (1 << SUB_BITS);
+    double width = (double) (1L << (msb - SUB_BITS));
+    return ((1 << SUB_BITS) + sub) * width + width / 2;
+}
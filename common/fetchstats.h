@@ -0,0 +1,59 @@
+/**
+ * @file fetchstats.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief fetchstats collects the latency and size of every fetch made by http and evfetch, for benchmarking a crawl
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __FETCH_STATS_H_
+#define __FETCH_STATS_H_
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief function to start collecting (and clear anything collected before); collection is off until called
+ *
+ */
+void fetchstatsEnable(void);
+
+/**
+ * @brief function to read a monotonic clock
+ *
+ * @return long microseconds since an arbitrary start
+ */
+long fetchstatsClock(void);
+
+/**
+ * @brief function to record one fetch; does nothing unless fetchstatsEnable was called. Thread-safe
+ *
+ * @param micros microseconds from sending the request to reading the whole response
+ * @param bytes bytes received for the response (headers and body as sent, before decoding)
+ * @param ok true if the page was fetched (200) or found not modified (304)
+ */
+void fetchstatsRecord(const long micros, const size_t bytes, const bool ok);
+
+/**
+ * @brief function to get a latency percentile of the fetches recorded
+ *
+ * @param p percentile (0 to 100)
+ * @return double latency in milliseconds (within about 3%), or 0 if nothing was recorded
+ */
+double fetchstatsPercentile(const double p);
+
+/**
+ * @brief function to print a summary of the fetches recorded
+ *
+ * @param fp file to print to
+ * @param seconds wall clock time the fetches took, to compute rates
+ * do
+ *  - print pages fetched, failures, bytes, pages/s and bytes/s
+ *  - print the p50, p90 and p99 fetch latency
+ */
+void fetchstatsReport(FILE *fp, const double seconds);
+
+#endif
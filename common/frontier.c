@@ -0,0 +1,542 @@
+/**
+ * @file frontier.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in frontier.h (a depth ordered crawl frontier on chunked queues)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "frontier.h"
+#include "webpage.h"
+#include "file.h"
+#include "mem.h"
+
+enum { CHUNK_SLOTS = 256 };     // webpages held by one chunk
+
+/**
+ * @brief a fixed size block of queue slots; chunks are linked head to tail
+ *
+ */
+typedef struct chunk {
+    struct chunk *next;
+    webpage_t *slot[CHUNK_SLOTS];
+} chunk_t;
+
+/**
+ * @brief a webpage in a scored level and the order it was pushed in
+ *
+ */
+typedef struct scored {
+    int score;
+    unsigned long seq;
+    webpage_t *page;
+} scored_t;
+
+/**
+ * @brief the webpages of one depth: a chunked FIFO queue, or a max-heap when the frontier is scored
+ *
+ */
+typedef struct level {
+    chunk_t *head;      // chunk holding the next page to pop
+    chunk_t *tail;      // chunk receiving the next push
+    int headPos;        // next slot to pop in head
+    int tailPos;        // next free slot in tail
+    scored_t *heap;     // scored pages (scored frontier only)
+    int heapCap;        // capacity of heap
+    int count;          // pages at this depth held in memory
+    FILE *spillOut;     // spill file opened for appending, or NULL
+    FILE *spillIn;      // spill file opened for reading back
+    int spilled;        // pages in the spill file not yet read back
+} level_t;
+
+struct frontier {
+    bool scored;        // pages of a depth leave by score rather than push order
+    level_t *levels;    // one level per depth
+    int nLevels;        // number of levels allocated
+    int low;            // no level below low holds a page
+    int size;           // pages in the frontier
+    chunk_t *spare;     // emptied chunks kept for reuse
+    unsigned long seq;  // pushes so far; breaks score ties in push order
+    char *spillDir;     // directory of the spill files, or NULL to keep every page in memory
+    int window;         // pages kept in memory before spilling
+    int inMemory;       // pages held in memory
+};
+
+/**
+ * @brief function to make sure the frontier has a level for depth
+ *
+ */
+static bool levelsReserve(frontier_t *frontier, const int depth);
+
+/**
+ * @brief function to find the shallowest level holding a page, reading spilled pages back if needed, or NULL
+ *
+ */
+static level_t *lowestLevel(frontier_t *frontier);
+
+/**
+ * @brief function to add a page to the in-memory queue (or heap) of a level
+ *
+ */
+static bool memPush(frontier_t *frontier, level_t *level, webpage_t *page, const int score);
+
+/**
+ * @brief function to append a page to the spill file of its level and delete the page
+ *
+ */
+static bool spillPush(frontier_t *frontier, level_t *level, webpage_t *page, const int score);
+
+/**
+ * @brief function to read a batch of spilled pages of a level back into memory
+ *
+ */
+static void spillLoad(frontier_t *frontier, level_t *level, const int depth);
+
+/**
+ * @brief function to close and remove the spill file of a level
+ *
+ */
+static void spillClose(frontier_t *frontier, const int depth);
+
+/**
+ * @brief function to write the pages of one level to an open file as frontierSave does
+ *
+ */
+static bool levelSave(frontier_t *frontier, const int depth, FILE *fp);
+
+/**
+ * @brief function to order scored entries by push order (for qsort)
+ *
+ */
+static int seqCompare(const void *a, const void *b);
+
+/**
+ * @brief function to get a chunk from the spare list or the heap
+ *
+ */
+static chunk_t *chunkTake(frontier_t *frontier);
+
+/**
+ * @brief function to sift the entry at i up or down the heap of a scored level
+ *
+ */
+static void heapUp(scored_t *heap, int i);
+static void heapDown(scored_t *heap, const int count, int i);
+
+/**
+ * @brief function to tell whether scored entry a should leave before b
+ *
+ */
+static bool scoredBefore(const scored_t *a, const scored_t *b);
+
+/* function to make a new, empty frontier */
+/* see frontier.h for more information */
+frontier_t *frontierNew(const bool scored) {
+    frontier_t *frontier = mem_calloc(1, sizeof(frontier_t));
+    if (frontier == NULL) {
+        return NULL;
+    }
+    frontier->scored = scored;
+    return frontier;
+}
+
+/* function to add a webpage to the frontier */
+/* see frontier.h for more information */
+bool frontierPush(frontier_t *frontier, webpage_t *page, const int score) {
+    if (frontier == NULL || page == NULL || webpage_getDepth(page) < 0) {   // validate arguments
+        return false;
+    }
+    int depth = webpage_getDepth(page);
+    if (!levelsReserve(frontier, depth)) {
+        return false;
+    }
+    level_t *level = &frontier->levels[depth];
+    // once a level spills, later pages follow it to the file so the level stays in push order
+    bool spill = frontier->spillDir != NULL && (level->spilled > 0 || frontier->inMemory >= frontier->window);
+    if (!(spill ? spillPush(frontier, level, page, score) : memPush(frontier, level, page, score))) {
+        return false;
+    }
+    frontier->size++;
+    if (depth < frontier->low) {    // a page may arrive below pages already handed out
+        frontier->low = depth;
+    }
+    return true;
+}
+
+/* function to bound the pages the frontier keeps in memory, spilling the rest to files in directory */
+/* see frontier.h for more information */
+bool frontierSpill(frontier_t *frontier, const char *directory, const int window) {
+    if (frontier == NULL || directory == NULL || window < 1 || frontier->spillDir != NULL) {  // validate arguments
+        return false;
+    }
+    frontier->spillDir = mem_malloc(strlen(directory) + 1);
+    if (frontier->spillDir == NULL) {
+        return false;
+    }
+    strcpy(frontier->spillDir, directory);
+    frontier->window = window;
+    return true;
+}
+
+/* function to get the webpage frontierPop would return, without removing it */
+/* see frontier.h for more information */
+webpage_t *frontierPeek(frontier_t *frontier) {
+    level_t *level = lowestLevel(frontier);
+    if (level == NULL) {
+        return NULL;
+    }
+    return frontier->scored ? level->heap[0].page : level->head->slot[level->headPos];
+}
+
+/* function to remove and return the next webpage */
+/* see frontier.h for more information */
+webpage_t *frontierPop(frontier_t *frontier) {
+    level_t *level = lowestLevel(frontier);
+    if (level == NULL) {
+        return NULL;
+    }
+    webpage_t *page;
+    level->count--;
+    frontier->size--;
+    frontier->inMemory--;
+    if (frontier->scored) {
+        page = level->heap[0].page;
+        level->heap[0] = level->heap[level->count];
+        heapDown(level->heap, level->count, 0);
+        return page;
+    }
+    page = level->head->slot[level->headPos++];
+    if (level->headPos == CHUNK_SLOTS || level->count == 0) {   // head chunk used up: keep it for reuse
+        chunk_t *chunk = level->head;
+        level->head = chunk->next;
+        level->headPos = 0;
+        if (level->head == NULL) {
+            level->tail = NULL;
+        }
+        chunk->next = frontier->spare;
+        frontier->spare = chunk;
+    }
+    return page;
+}
+
+/* function to get the number of webpages in the frontier */
+/* see frontier.h for more information */
+int frontierSize(frontier_t *frontier) {
+    return frontier == NULL ? 0 : frontier->size;
+}
+
+/* function to write every webpage of the frontier to an open file, leaving the frontier as it is */
+/* see frontier.h for more information */
+bool frontierSave(frontier_t *frontier, FILE *fp) {
+    if (frontier == NULL || fp == NULL) {   // validate arguments
+        return false;
+    }
+    fprintf(fp, "%d\n", frontier->size);
+    for (int depth = frontier->low; depth < frontier->nLevels; depth++) {
+        if (!levelSave(frontier, depth, fp)) {
+            return false;
+        }
+    }
+    return !ferror(fp);
+}
+
+/* function to push the webpages written by frontierSave from an open file */
+/* see frontier.h for more information */
+bool frontierLoad(frontier_t *frontier, FILE *fp) {
+    if (frontier == NULL || fp == NULL) {   // validate arguments
+        return false;
+    }
+    int count;
+    if (fscanf(fp, "%d", &count) != 1) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        int depth, score;
+        if (fscanf(fp, "%d %d ", &depth, &score) != 2) {
+            return false;
+        }
+        char *url = file_readLine(fp);
+        webpage_t *page = url == NULL ? NULL : webpage_new(url, depth, NULL);
+        if (page == NULL) {
+            free(url);
+            return false;
+        }
+        if (!frontierPush(frontier, page, score)) {
+            webpage_delete(page);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* function to delete a frontier */
+/* see frontier.h for more information */
+void frontierDelete(frontier_t *frontier, void (*itemdelete)(void *item)) {
+    if (frontier == NULL) {
+        return;
+    }
+    for (int i = 0; i < frontier->nLevels; i++) {   // spilled pages are dropped without being read back
+        spillClose(frontier, i);
+    }
+    webpage_t *page;
+    while ((page = frontierPop(frontier)) != NULL) {
+        if (itemdelete != NULL) {
+            itemdelete(page);
+        }
+    }
+    for (int i = 0; i < frontier->nLevels; i++) {
+        free(frontier->levels[i].heap);
+    }
+    while (frontier->spare != NULL) {
+        chunk_t *next = frontier->spare->next;
+        mem_free(frontier->spare);
+        frontier->spare = next;
+    }
+    free(frontier->levels);
+    mem_free(frontier->spillDir);
+    mem_free(frontier);
+}
+
+/* function to make sure the frontier has a level for depth */
+static bool levelsReserve(frontier_t *frontier, const int depth) {
+    if (depth < frontier->nLevels) {
+        return true;
+    }
+    int n = frontier->nLevels == 0 ? 8 : frontier->nLevels;
+    while (n <= depth) {
+        n *= 2;
+    }
+    level_t *levels = realloc(frontier->levels, n * sizeof(level_t));
+    if (levels == NULL) {
+        return false;
+    }
+    memset(levels + frontier->nLevels, 0, (n - frontier->nLevels) * sizeof(level_t));
+    frontier->levels = levels;
+    frontier->nLevels = n;
+    return true;
+}
+
+/* function to find the shallowest level holding a page, reading spilled pages back if needed, or NULL */
+static level_t *lowestLevel(frontier_t *frontier) {
+    while (frontier != NULL && frontier->size > 0) {
+        level_t *level = &frontier->levels[frontier->low];
+        if (level->count > 0) {
+            return level;
+        } else if (level->spilled > 0) {
+            spillLoad(frontier, level, frontier->low);   // loop again in case the read failed
+        } else {
+            frontier->low++;    // size > 0 so a deeper level is not empty
+        }
+    }
+    return NULL;
+}
+
+/* function to add a page to the in-memory queue (or heap) of a level */
+static bool memPush(frontier_t *frontier, level_t *level, webpage_t *page, const int score) {
+    if (frontier->scored) {
+        if (level->count == level->heapCap) {   // grow the heap
+            int cap = level->heapCap == 0 ? CHUNK_SLOTS : level->heapCap * 2;
+            scored_t *heap = realloc(level->heap, cap * sizeof(scored_t));
+            if (heap == NULL) {
+                return false;
+            }
+            level->heap = heap;
+            level->heapCap = cap;
+        }
+        level->heap[level->count] = (scored_t) { score, frontier->seq++, page };
+        heapUp(level->heap, level->count);
+    } else {
+        if (level->tail == NULL || level->tailPos == CHUNK_SLOTS) {   // link a new chunk at the tail
+            chunk_t *chunk = chunkTake(frontier);
+            if (chunk == NULL) {
+                return false;
+            }
+            if (level->tail == NULL) {
+                level->head = chunk;
+                level->headPos = 0;
+            } else {
+                level->tail->next = chunk;
+            }
+            level->tail = chunk;
+            level->tailPos = 0;
+        }
+        level->tail->slot[level->tailPos++] = page;
+    }
+    level->count++;
+    frontier->inMemory++;
+    return true;
+}
+
+/* function to append a page to the spill file of its level and delete the page */
+static bool spillPush(frontier_t *frontier, level_t *level, webpage_t *page, const int score) {
+    if (level->spillOut == NULL) {  // first page to spill at this depth: start a new file
+        int depth = level - frontier->levels;
+        char path[strlen(frontier->spillDir) + 32];
+        sprintf(path, "%s/.frontier%d", frontier->spillDir, depth);
+        level->spillOut = fopen(path, "w");
+        level->spillIn = level->spillOut == NULL ? NULL : fopen(path, "r");
+        if (level->spillIn == NULL) {
+            spillClose(frontier, depth);
+            return false;
+        }
+    }
+    if (fprintf(level->spillOut, "%s %d\n", webpage_getURL(page), score) < 0) {   // one line per page: url and score
+        return false;
+    }
+    level->spilled++;
+    webpage_delete(page);
+    return true;
+}
+
+/* function to read a batch of spilled pages of a level back into memory */
+static void spillLoad(frontier_t *frontier, level_t *level, const int depth) {
+    int batch = frontier->window - frontier->inMemory;
+    if (batch > CHUNK_SLOTS) batch = CHUNK_SLOTS;
+    if (batch < 1) batch = 1;   // the window is full of other levels: read one at a time
+    fflush(level->spillOut);
+    clearerr(level->spillIn);
+    for (int i = 0; i < batch && level->spilled > 0; i++) {
+        char *line = file_readLine(level->spillIn);
+        if (line == NULL) {     // the file lost pages: forget them
+            frontier->size -= level->spilled;
+            level->spilled = 0;
+            break;
+        }
+        level->spilled--;
+        char *space = strrchr(line, ' ');
+        int score = space == NULL ? 0 : (int) strtol(space + 1, NULL, 10);
+        if (space != NULL) *space = '\0';
+        webpage_t *page = webpage_new(line, depth, NULL);
+        if (page == NULL || !memPush(frontier, level, page, score)) {
+            if (page != NULL) webpage_delete(page);
+            else free(line);
+            frontier->size--;
+        }
+    }
+    if (level->spilled == 0) {  // file drained: remove it so the next spill starts afresh
+        spillClose(frontier, depth);
+    }
+}
+
+/* function to close and remove the spill file of a level */
+static void spillClose(frontier_t *frontier, const int depth) {
+    level_t *level = &frontier->levels[depth];
+    if (level->spillOut == NULL) {
+        return;
+    }
+    fclose(level->spillOut);
+    if (level->spillIn != NULL) fclose(level->spillIn);
+    level->spillOut = level->spillIn = NULL;
+    frontier->size -= level->spilled;
+    level->spilled = 0;
+    char path[strlen(frontier->spillDir) + 32];
+    sprintf(path, "%s/.frontier%d", frontier->spillDir, depth);
+    remove(path);
+}
+
+/* function to write the pages of one level to an open file as frontierSave does */
+static bool levelSave(frontier_t *frontier, const int depth, FILE *fp) {
+    level_t *level = &frontier->levels[depth];
+    if (frontier->scored && level->count > 0) {     // heap order is not push order: sort a copy
+        scored_t *byPush = malloc(level->count * sizeof(scored_t));
+        if (byPush == NULL) {
+            return false;
+        }
+        memcpy(byPush, level->heap, level->count * sizeof(scored_t));
+        qsort(byPush, level->count, sizeof(scored_t), seqCompare);
+        for (int i = 0; i < level->count; i++) {
+            fprintf(fp, "%d %d %s\n", depth, byPush[i].score, webpage_getURL(byPush[i].page));
+        }
+        free(byPush);
+    } else if (level->count > 0) {
+        for (chunk_t *chunk = level->head; chunk != NULL; chunk = chunk->next) {
+            int end = chunk == level->tail ? level->tailPos : CHUNK_SLOTS;
+            for (int i = chunk == level->head ? level->headPos : 0; i < end; i++) {
+                fprintf(fp, "%d 0 %s\n", depth, webpage_getURL(chunk->slot[i]));
+            }
+        }
+    }
+    if (level->spilled > 0) {   // copy the unread part of the spill file through a handle of our own
+        fflush(level->spillOut);
+        char path[strlen(frontier->spillDir) + 32];
+        sprintf(path, "%s/.frontier%d", frontier->spillDir, depth);
+        FILE *in = fopen(path, "r");
+        if (in == NULL || fseek(in, ftell(level->spillIn), SEEK_SET) != 0) {
+            if (in != NULL) fclose(in);
+            return false;
+        }
+        for (int i = 0; i < level->spilled; i++) {
+            char *line = file_readLine(in);
+            if (line == NULL) {
+                fclose(in);
+                return false;
+            }
+            char *space = strrchr(line, ' ');
+            if (space != NULL) *space = '\0';
+            fprintf(fp, "%d %s %s\n", depth, space == NULL ? "0" : space + 1, line);
+            free(line);
+        }
+        fclose(in);
+    }
+    return true;
+}
+
+/* function to order scored entries by push order (for qsort) */
+static int seqCompare(const void *a, const void *b) {
+    unsigned long x = ((const scored_t *) a)->seq, y = ((const scored_t *) b)->seq;
+    return x < y ? -1 : x > y;
+}
+
+/* function to get a chunk from the spare list or the heap */
+static chunk_t *chunkTake(frontier_t *frontier) {
+    chunk_t *chunk = frontier->spare;
+    if (chunk != NULL) {
+        frontier->spare = chunk->next;
+    } else {
+        chunk = mem_malloc(sizeof(chunk_t));
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+    chunk->next = NULL;
+    return chunk;
+}
+
+/* function to sift the entry at i up the heap of a scored level */
+static void heapUp(scored_t *heap, int i) {
+    while (i > 0 && scoredBefore(&heap[i], &heap[(i - 1) / 2])) {
+        scored_t tmp = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+/* function to sift the entry at i down the heap of a scored level */
+static void heapDown(scored_t *heap, const int count, int i) {
+    for (;;) {
+        int best = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < count && scoredBefore(&heap[left], &heap[best])) best = left;
+        if (right < count && scoredBefore(&heap[right], &heap[best])) best = right;
+        if (best == i) {
+            return;
+        }
+        scored_t tmp = heap[i];
+        heap[i] = heap[best];
+        heap[best] = tmp;
+        i = best;
+    }
+}
+
+/* function to tell whether scored entry a should leave before b */
+static bool scoredBefore(const scored_t *a, const scored_t *b) {
+    return a->score > b->score || (a->score == b->score && a->seq < b->seq);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file frontier.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief frontier provides the crawl frontier: webpages waiting to be fetched, handed out shallowest depth first
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __FRONTIER_H_
+#define __FRONTIER_H_
+#include <stdio.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+/**
+ * @brief opaque type holding one queue of webpages per depth
+ *
+ */
+typedef struct frontier frontier_t;
+
+/**
+ * @brief function to make a new, empty frontier
+ *
+ * @param scored false to hand out the pages of a depth in the order they were pushed (FIFO),
+ *  true to hand out the pages of a depth highest score first (ties in push order)
+ * @return frontier_t* new frontier or NULL on failure
+ */
+frontier_t *frontierNew(const bool scored);
+
+/**
+ * @brief function to add a webpage to the frontier
+ *
+ * @param frontier frontier
+ * @param page webpage to add; the frontier holds it until it is popped
+ * @param score link score of the page; only used by a scored frontier
+ * @return true if the page was added
+ * do
+ *  - nothing if frontier or page is NULL or the page depth is negative
+ *  - O(1) for a FIFO frontier: pages are kept in fixed size chunks that are reused once emptied
+ */
+bool frontierPush(frontier_t *frontier, webpage_t *page, const int score);
+
+/**
+ * @brief function to bound the pages the frontier keeps in memory, spilling the rest to files in directory
+ *
+ * @param frontier frontier
+ * @param directory directory to hold the spill files (.frontier<depth>); the crawler uses its pageDirectory
+ * @param window number of pages kept in memory
+ * @return true if spilling was turned on
+ * do
+ *  - nothing if an argument is invalid or spilling is already on
+ *  - once window pages are in memory, a pushed page is appended (url and score) to the spill file of its depth
+ *    and deleted with webpage_delete, so the frontier must own the pages pushed to it
+ *  - a depth that has spilled keeps appending to its file until the file is read back, so pages still leave in push order
+ *  - pages are read back in batches when their depth is next; a scored frontier only orders the pages in memory
+ */
+bool frontierSpill(frontier_t *frontier, const char *directory, const int window);
+
+/**
+ * @brief function to get the webpage frontierPop would return, without removing it
+ *
+ * @param frontier frontier
+ * @return webpage_t* next webpage or NULL if the frontier is empty
+ */
+webpage_t *frontierPeek(frontier_t *frontier);
+
+/**
+ * @brief function to remove and return the next webpage: the shallowest depth first, then push order (or score)
+ *
+ * @param frontier frontier
+ * @return webpage_t* next webpage (the caller now owns it) or NULL if the frontier is empty
+ */
+webpage_t *frontierPop(frontier_t *frontier);
+
+/**
+ * @brief function to get the number of webpages in the frontier
+ *
+ * @param frontier frontier
+ * @return int number of webpages (0 if frontier is NULL)
+ */
+int frontierSize(frontier_t *frontier);
+
+/**
+ * @brief function to write every webpage of the frontier (url, depth and score) to an open file, leaving the frontier as it is
+ *
+ * @param frontier frontier
+ * @param fp file open for writing
+ * @return true if the frontier was written
+ * writes a line with the number of pages, then one "depth score url" line per page in the order they would be popped
+ * (for a scored frontier, in push order within a depth)
+ */
+bool frontierSave(frontier_t *frontier, FILE *fp);
+
+/**
+ * @brief function to push the webpages written by frontierSave from an open file
+ *
+ * @param frontier frontier to push them to
+ * @param fp file open for reading, positioned where frontierSave started writing
+ * @return true if every page was read and pushed
+ */
+bool frontierLoad(frontier_t *frontier, FILE *fp);
+
+/**
+ * @brief function to delete a frontier
+ *
+ * @param frontier frontier to delete
+ * @param itemdelete function called on every webpage still in the frontier (may be NULL)
+ * spilled pages are dropped with their files rather than read back
+ */
+void frontierDelete(frontier_t *frontier, void (*itemdelete)(void *item));
+
+#endif
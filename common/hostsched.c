@@ -0,0 +1,206 @@
+/**
+ * @file hostsched.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in hostsched.h (a per-host politeness scheduler)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L     // clock_gettime, nanosleep
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "hostsched.h"
+#include "hashtable.h"
+#include "mem.h"
+
+/**
+ * @brief policy and state of one host
+ *
+ */
+typedef struct hostSlot {
+    int hostLimit;      // slots allowed in flight
+    long delayMs;       // milliseconds between fetch starts
+    int inFlight;       // slots in flight
+    long nextAllowed;   // time (ms) the next fetch may start
+} host_slot_t;
+
+struct hostsched {
+    int hostLimit;          // default policy
+    long delayMs;
+    hashtable_t *hosts;     // hostname -> host_slot_t
+    pthread_mutex_t lock;   // guards hosts
+    pthread_cond_t released;    // signalled when a slot is released
+};
+
+/**
+ * @brief function to get the current monotonic time in milliseconds
+ *
+ */
+static long nowMs(void);
+
+/**
+ * @brief function to find the slot of a host, making it with the default policy if needed; call with lock held
+ *
+ */
+static host_slot_t *slotFor(hostsched_t *sched, const char *hostname);
+
+/* function to make a new scheduler; safe to share between threads */
+/* see hostsched.h for more information */
+hostsched_t *hostschedNew(const int hostLimit, const long delayMs) {
+    if (hostLimit < 1 || delayMs < 0) {   // validate arguments
+        return NULL;
+    }
+    hostsched_t *sched = mem_malloc(sizeof(hostsched_t));
+    if (sched == NULL) {
+        return NULL;
+    }
+    sched->hosts = hashtable_new(31);
+    if (sched->hosts == NULL) {
+        mem_free(sched);
+        return NULL;
+    }
+    sched->hostLimit = hostLimit;
+    sched->delayMs = delayMs;
+    pthread_mutex_init(&sched->lock, NULL);
+    pthread_cond_init(&sched->released, NULL);
+    return sched;
+}
+
+/* function to give one host its own policy */
+/* see hostsched.h for more information */
+bool hostschedSetPolicy(hostsched_t *sched, const char *hostname, const int hostLimit, const long delayMs) {
+    if (sched == NULL || hostname == NULL || hostLimit < 1 || delayMs < 0) {  // validate arguments
+        return false;
+    }
+    pthread_mutex_lock(&sched->lock);
+    host_slot_t *slot = slotFor(sched, hostname);
+    if (slot != NULL) {
+        slot->hostLimit = hostLimit;
+        slot->delayMs = delayMs;
+        pthread_cond_broadcast(&sched->released);   // a raised limit may free waiters
+    }
+    pthread_mutex_unlock(&sched->lock);
+    return slot != NULL;
+}
+
+/* function to parse a policy of the form host:limit:delayMs and give it to the host */
+/* see hostsched.h for more information */
+bool hostschedParsePolicy(hostsched_t *sched, const char *policy) {
+    if (sched == NULL || policy == NULL) {    // validate arguments
+        return false;
+    }
+    char hostname[strlen(policy) + 1];
+    int hostLimit;
+    long delayMs;
+    if (sscanf(policy, "%[^:]:%d:%ld", hostname, &hostLimit, &delayMs) != 3) {
+        return false;
+    }
+    return hostschedSetPolicy(sched, hostname, hostLimit, delayMs);
+}
+
+/* function to wait until n fetches to a host may start and claim them as one slot */
+/* see hostsched.h for more information */
+void hostschedAcquire(hostsched_t *sched, const char *hostname, const int n) {
+    if (sched == NULL || hostname == NULL) {  // validate arguments
+        return;
+    }
+    pthread_mutex_lock(&sched->lock);
+    host_slot_t *slot = slotFor(sched, hostname);
+    if (slot == NULL) {
+        pthread_mutex_unlock(&sched->lock);
+        return;
+    }
+    while (slot->inFlight >= slot->hostLimit) {   // wait for another slot of this host to be released
+        pthread_cond_wait(&sched->released, &sched->lock);
+    }
+    long now = nowMs();
+    long start = slot->nextAllowed > now ? slot->nextAllowed : now;   // reserve the next start time
+    slot->nextAllowed = start + slot->delayMs * (n > 0 ? n : 1);
+    slot->inFlight++;
+    pthread_mutex_unlock(&sched->lock);
+    if (start > now) {  // sleep outside the lock so other hosts are not held up
+        struct timespec ts = { (start - now) / 1000, ((start - now) % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+}
+
+/* function to claim a slot for n fetches to a host without blocking */
+/* see hostsched.h for more information */
+long hostschedTryAcquire(hostsched_t *sched, const char *hostname, const int n) {
+    if (sched == NULL || hostname == NULL) {  // validate arguments
+        return 0;
+    }
+    long wait = 0;
+    pthread_mutex_lock(&sched->lock);
+    host_slot_t *slot = slotFor(sched, hostname);
+    long now = nowMs();
+    if (slot == NULL) {
+        wait = 0;
+    } else if (slot->inFlight >= slot->hostLimit) {
+        wait = -1;
+    } else if (slot->nextAllowed > now) {
+        wait = slot->nextAllowed - now;
+    } else {
+        slot->nextAllowed = now + slot->delayMs * (n > 0 ? n : 1);
+        slot->inFlight++;
+    }
+    pthread_mutex_unlock(&sched->lock);
+    return wait;
+}
+
+/* function to release a slot claimed with hostschedAcquire or hostschedTryAcquire */
+/* see hostsched.h for more information */
+void hostschedRelease(hostsched_t *sched, const char *hostname) {
+    if (sched == NULL || hostname == NULL) {  // validate arguments
+        return;
+    }
+    pthread_mutex_lock(&sched->lock);
+    host_slot_t *slot = hashtable_find(sched->hosts, hostname);
+    if (slot != NULL && slot->inFlight > 0) {
+        slot->inFlight--;
+        pthread_cond_broadcast(&sched->released);
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
+
+/* function to delete a scheduler */
+/* see hostsched.h for more information */
+void hostschedDelete(hostsched_t *sched) {
+    if (sched == NULL) {
+        return;
+    }
+    hashtable_delete(sched->hosts, mem_free);
+    pthread_cond_destroy(&sched->released);
+    pthread_mutex_destroy(&sched->lock);
+    mem_free(sched);
+}
+
+/* function to get the current monotonic time in milliseconds */
+static long nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/* function to find the slot of a host, making it with the default policy if needed; call with lock held */
+static host_slot_t *slotFor(hostsched_t *sched, const char *hostname) {
+    host_slot_t *slot = hashtable_find(sched->hosts, hostname);
+    if (slot == NULL) {
+        slot = mem_calloc(1, sizeof(host_slot_t));
+        if (slot == NULL) {
+            return NULL;
+        }
+        slot->hostLimit = sched->hostLimit;
+        slot->delayMs = sched->delayMs;
+        hashtable_insert(sched->hosts, hostname, slot);
+    }
+    return slot;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file hostsched.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief hostsched provides a per-host politeness scheduler: each host has a limit on fetches in flight and a delay between fetches
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __HOST_SCHED_H_
+#define __HOST_SCHED_H_
+#include <stdbool.h>
+
+/**
+ * @brief opaque type holding the policy and the state (fetches in flight, next allowed time) of every host
+ *
+ */
+typedef struct hostsched hostsched_t;
+
+/**
+ * @brief function to make a new scheduler; safe to share between threads
+ *
+ * @param hostLimit default number of fetches allowed in flight to one host
+ * @param delayMs default number of milliseconds between the starts of two fetches to one host
+ * @return hostsched_t* new scheduler or NULL on failure
+ */
+hostsched_t *hostschedNew(const int hostLimit, const long delayMs);
+
+/**
+ * @brief function to give one host its own policy
+ *
+ * @param sched scheduler
+ * @param hostname host the policy applies to
+ * @param hostLimit number of fetches allowed in flight to the host
+ * @param delayMs number of milliseconds between the starts of two fetches to the host
+ * @return true if the policy was set
+ */
+bool hostschedSetPolicy(hostsched_t *sched, const char *hostname, const int hostLimit, const long delayMs);
+
+/**
+ * @brief function to parse a policy of the form host:limit:delayMs and give it to the host
+ *
+ * @param sched scheduler
+ * @param policy policy string
+ * @return true if the policy was valid and set
+ */
+bool hostschedParsePolicy(hostsched_t *sched, const char *policy);
+
+/**
+ * @brief function to wait until n fetches to a host may start and claim them as one slot
+ *
+ * @param sched scheduler
+ * @param hostname host to fetch from
+ * @param n number of requests that will be sent (pipelined) in this slot
+ * do
+ *  - wait while the host has hostLimit slots in flight
+ *  - reserve the next start time of the host and push it n delays later
+ *  - sleep until the reserved start time
+ */
+void hostschedAcquire(hostsched_t *sched, const char *hostname, const int n);
+
+/**
+ * @brief function to claim a slot for n fetches to a host without blocking
+ *
+ * @param sched scheduler
+ * @param hostname host to fetch from
+ * @param n number of requests that will be sent in this slot
+ * @return long 0 if the slot was claimed,
+ *  the number of milliseconds until the host allows another fetch,
+ *  or -1 if the host has hostLimit slots in flight (retry after a release)
+ */
+long hostschedTryAcquire(hostsched_t *sched, const char *hostname, const int n);
+
+/**
+ * @brief function to release a slot claimed with hostschedAcquire or hostschedTryAcquire
+ *
+ * @param sched scheduler
+ * @param hostname host the slot was claimed for
+ */
+void hostschedRelease(hostsched_t *sched, const char *hostname);
+
+/**
+ * @brief function to delete a scheduler
+ *
+ * @param sched scheduler to delete
+ */
+void hostschedDelete(hostsched_t *sched);
+
+#endif
@@ -0,0 +1,661 @@
+/**
+ * @file http.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in http.h (a thread-safe page fetcher that can be shared by the crawler's fetch workers)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _GNU_SOURCE     // getaddrinfo, strdup, strncasecmp
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "http.h"
+#include "inflate.h"
+#include "httpbody.h"
+#include "fetchstats.h"
+#include "webpage.h"
+#include "mem.h"
+
+#ifndef HttpIdleLimit
+#define HttpIdleLimit 8 // idle keep-alive connections kept per host
+#endif
+
+enum { CONN_BUF = 16384 };          // bytes buffered per connection
+static const int MAX_TRY = 3;       // maximum attempts to connect
+static const int HTTP_PORT = 80;    // default web server port
+static const int MAX_LINE = 8192;   // longest status or header line accepted
+enum { MAX_CODING = 32 };           // longest Content-Encoding value kept
+enum { RESPONSE_BROKEN = -1, RESPONSE_UNUSABLE = -2 };  // readResponse failures: resend on another connection, or give up
+
+/**
+ * @brief an open connection to a host and the bytes read from it but not yet consumed
+ *
+ */
+typedef struct httpConn {
+    int fd;                     // connected socket
+    char *hostname;             // host the socket is connected to
+    int port;                   // port the socket is connected to
+    size_t start;               // first unconsumed byte in buf
+    size_t end;                 // end of the bytes read into buf
+    size_t received;            // bytes received on the socket, for fetchstats
+    char buf[CONN_BUF];         // read buffer
+    struct httpConn *next;      // next idle connection
+} httpconn_t;
+
+static httpconn_t *idleConns = NULL;    // idle keep-alive connections, most recently used first
+static pthread_mutex_t idleLock = PTHREAD_MUTEX_INITIALIZER;    // guards idleConns
+static struct sockaddr_in connectTo;    // address every fetch goes to if connectToSet (see httpConnectTo)
+static bool connectToSet = false;
+
+/**
+ * @brief function to open a connection to hostname:port, trying up to MAX_TRY times
+ *
+ * @param hostname host to connect to
+ * @param port port to connect to
+ * @return httpconn_t* new connection or NULL on failure
+ * unlike gethostbyname, getaddrinfo keeps no static state so concurrent workers may call this
+ */
+static httpconn_t *connOpen(const char *hostname, const int port);
+
+/**
+ * @brief function to take an idle keep-alive connection to hostname:port from the cache
+ *
+ * @return httpconn_t* idle connection or NULL if there is none
+ */
+static httpconn_t *connTake(const char *hostname, const int port);
+
+/**
+ * @brief function to return a connection to the cache once its last response has been read in full
+ *
+ * @param conn connection to keep; closed instead if HttpIdleLimit connections to its host are idle
+ */
+static void connPut(httpconn_t *conn);
+
+/**
+ * @brief function to close a connection and free it
+ *
+ * @param conn connection to close
+ */
+static void connClose(httpconn_t *conn);
+
+/**
+ * @brief function to send a GET request for pathname on a connection, conditional if validators are set
+ *
+ * @return true if the whole request was written to the socket
+ */
+static bool connSendGet(httpconn_t *conn, const char *pathname, const http_validators_t *validators);
+
+/**
+ * @brief function to read the next line from a connection, dropping the CRLF
+ *
+ * @param conn connection to read from
+ * @param line buffer of MAX_LINE bytes to read into
+ * @return int length of the line or -1 on EOF, error or a line longer than MAX_LINE
+ */
+static int connReadLine(httpconn_t *conn, char *line);
+
+/**
+ * @brief function to read one response from a connection
+ *
+ * @param conn connection to read from
+ * @param body pointer to char pointer to store the malloc'd, null terminated body (NULL if none)
+ * @param keepAlive pointer to bool set to whether the connection can carry another response
+ * @param validators validators to refresh from a 200 or 304 response (may be NULL)
+ * @return int status code of the response, with *body NULL if it could not be decoded;
+ * RESPONSE_BROKEN if the connection failed or closed before the response was read (worth sending again);
+ * RESPONSE_UNUSABLE if the response itself cannot be read (a garbled status line, malformed framing or a body
+ * over HttpBodyLimit), which sending again would not change; the connection is out of step after either
+ * do
+ *  - parse the status line and the Content-Length, Transfer-Encoding, Content-Encoding and Connection headers,
+ *    and the ETag and Last-Modified headers if validators is not NULL
+ *  - read a body framed by Content-Length, by chunked encoding or by the end of the connection with readBody
+ *  - decode a gzip or deflate body with httpDecodeBody
+ */
+static int readResponse(httpconn_t *conn, char **body, bool *keepAlive, http_validators_t *validators);
+
+/**
+ * @brief function to read a body from a connection, buffered bytes first
+ *
+ * @param conn connection to read from
+ * @param body reader started for the framing of the response
+ * @return int 1 if the body is whole, 0 if the connection failed or ended before the body did,
+ * -1 if the framing is malformed or the body too large
+ * data bytes are received straight into the body buffer in blocks as large as the framing allows,
+ * and never past the end of the body, so a pipelined response behind it stays on the connection
+ */
+static int readBody(httpconn_t *conn, httpbody_t *body);
+
+/**
+ * @brief function to replace a page with one holding the same url and depth and the given html
+ *
+ * @param page pointer to the webpage to replace
+ * @param html malloc'd html; freed on failure
+ * @return true if *page was replaced
+ */
+static bool pageAttach(webpage_t **page, char *html);
+
+/* function to fetch the html of a webpage; safe to call from several threads at once */
+/* see http.h for more information */
+bool httpFetch(webpage_t **page) {
+    if (page == NULL || *page == NULL || webpage_getURL(*page) == NULL || webpage_getHTML(*page) != NULL) {   // validate arguments
+        return false;
+    }
+    return httpFetchAll(page, 1) == 1;
+}
+
+/* function to fetch several pages of one host over one keep-alive connection */
+/* see http.h for more information */
+int httpFetchAll(webpage_t **pages, const int n) {
+    return httpFetchAllConditional(pages, n, NULL);
+}
+
+/* function to fetch several pages of one host, asking the server to skip unchanged ones */
+/* see http.h for more information */
+int httpFetchAllConditional(webpage_t **pages, const int n, http_validators_t *validators) {
+    if (pages == NULL || n < 1 || pages[0] == NULL) {   // validate arguments
+        return 0;
+    }
+    char *hostname, *pathname;
+    int port;
+    if (!httpBurstURL(webpage_getURL(pages[0]), &hostname, &port, &pathname)) {
+        return 0;
+    }
+    mem_free(pathname);
+    char *paths[n];     // pathname of each page, NULL if the page cannot be fetched on this host
+    for (int i = 0; i < n; i++) {
+        char *host;
+        int p;
+        paths[i] = NULL;
+        if (pages[i] != NULL && webpage_getHTML(pages[i]) == NULL
+            && httpBurstURL(webpage_getURL(pages[i]), &host, &p, &paths[i])) {
+            if (p != port || strcmp(host, hostname) != 0) {   // not on this host
+                mem_free(paths[i]);
+                paths[i] = NULL;
+            }
+            mem_free(host);
+        }
+    }
+
+    int fetched = 0;
+    int next = 0;       // first page whose response has not been read
+    int stalls = 0;     // connections that made no progress
+    while (next < n && stalls < MAX_TRY) {
+        httpconn_t *conn = connTake(hostname, port);
+        if (conn == NULL && (conn = connOpen(hostname, port)) == NULL) {
+            break;
+        }
+        int sent = next;    // pipeline every remaining request, then read the responses in order
+        for (; sent < n; sent++) {
+            if (paths[sent] != NULL && !connSendGet(conn, paths[sent], validators == NULL ? NULL : &validators[sent])) {
+                break;
+            }
+        }
+        bool keepAlive = true;
+        int start = next;
+        long sentAt = fetchstatsClock();    // pipelined: each response is timed from when the batch was sent
+        while (next < sent && keepAlive) {
+            if (paths[next] == NULL) {
+                next++;
+                continue;
+            }
+            char *body = NULL;
+            size_t received = conn->received;
+            int code = readResponse(conn, &body, &keepAlive, validators == NULL ? NULL : &validators[next]);
+            if (code == RESPONSE_BROKEN) {  // resend the rest on another connection
+                keepAlive = false;
+                break;
+            } else if (code == RESPONSE_UNUSABLE) {   // this page failed; the rest go on another connection
+                fetchstatsRecord(fetchstatsClock() - sentAt, conn->received - received, false);
+                keepAlive = false;
+                next++;
+                break;
+            }
+            fetchstatsRecord(fetchstatsClock() - sentAt, conn->received - received, code == 200 || code == 304);
+            if (code == 200 && body != NULL && pageAttach(&pages[next], body)) {
+                fetched++;
+            } else if (code == 304 && validators != NULL) {  // the stored copy is current
+                validators[next].notModified = true;
+                fetched++;
+            } else if (code != 200) {
+                free(body);
+            }
+            next++;
+        }
+        if (keepAlive && next == sent) {
+            connPut(conn);
+        } else {
+            connClose(conn);
+        }
+        stalls = (next == start) ? stalls + 1 : 0;
+    }
+    for (int i = 0; i < n; i++) {
+        mem_free(paths[i]);
+    }
+    mem_free(hostname);
+    return fetched;
+}
+
+/* function to send every fetch to one address instead of resolving the host of the url */
+/* see http.h for more information */
+bool httpConnectTo(const char *target) {
+    if (target == NULL) {
+        connectToSet = false;
+        return true;
+    }
+    char address[64];
+    int port, len = 0;
+    if (sscanf(target, "%63[^:]:%d%n", address, &port, &len) != 2 || target[len] != '\0' || port <= 0 || port > 65535) {
+        return false;
+    }
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(address, NULL, &hints, &res) != 0) {
+        return false;
+    }
+    memcpy(&connectTo, res->ai_addr, sizeof(connectTo));
+    connectTo.sin_port = htons(port);
+    freeaddrinfo(res);
+    connectToSet = true;
+    return true;
+}
+
+/* function to resolve hostname:port to an IPv4 address */
+/* see http.h for more information */
+bool httpResolve(const char *hostname, const int port, struct sockaddr_in *addr) {
+    if (hostname == NULL || addr == NULL) {    // validate arguments
+        return false;
+    }
+    if (connectToSet) {
+        *addr = connectTo;
+        return true;
+    }
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(hostname, service, &hints, &res) != 0) {
+        return false;
+    }
+    memcpy(addr, res->ai_addr, sizeof(*addr));
+    freeaddrinfo(res);
+    return true;
+}
+
+/* function to close every idle keep-alive connection */
+/* see http.h for more information */
+void httpCleanup(void) {
+    pthread_mutex_lock(&idleLock);
+    httpconn_t *conn = idleConns;
+    idleConns = NULL;
+    pthread_mutex_unlock(&idleLock);
+    while (conn != NULL) {
+        httpconn_t *next = conn->next;
+        connClose(conn);
+        conn = next;
+    }
+}
+
+/* function to write the conditional request headers for validators */
+/* see http.h for more information */
+int httpValidatorsFormat(const http_validators_t *validators, char *buf, const size_t size) {
+    if (validators == NULL) {   // an unconditional request has no extra headers
+        if (size > 0) buf[0] = '\0';
+        return 0;
+    }
+    const char *etag = validators->etag, *lastModified = validators->lastModified;
+    return snprintf(buf, size, "%s%s%s%s%s%s", etag == NULL ? "" : "If-None-Match: ", etag == NULL ? "" : etag,
+                    etag == NULL ? "" : "\r\n", lastModified == NULL ? "" : "If-Modified-Since: ",
+                    lastModified == NULL ? "" : lastModified, lastModified == NULL ? "" : "\r\n");
+}
+
+/* function to record a response header line in validators if it is an ETag or Last-Modified header */
+/* see http.h for more information */
+bool httpValidatorsParse(http_validators_t *validators, const char *line) {
+    if (validators == NULL || line == NULL) {   // validate arguments
+        return false;
+    }
+    char **field;
+    if (strncasecmp(line, "ETag:", 5) == 0) {
+        field = &validators->etag;
+        line += 5;
+    } else if (strncasecmp(line, "Last-Modified:", 14) == 0) {
+        field = &validators->lastModified;
+        line += 14;
+    } else {
+        return false;
+    }
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    size_t len = strcspn(line, "\r\n");
+    free(*field);
+    *field = len == 0 ? NULL : strndup(line, len);
+    return true;
+}
+
+/* function to free the strings held by validators and reset them */
+/* see http.h for more information */
+void httpValidatorsClear(http_validators_t *validators) {
+    if (validators == NULL) {
+        return;
+    }
+    free(validators->etag);
+    free(validators->lastModified);
+    validators->etag = validators->lastModified = NULL;
+    validators->notModified = false;
+}
+
+/* function to decode a response body according to its Content-Encoding header */
+/* see http.h for more information */
+char *httpDecodeBody(const char *encoding, char *body, size_t *len) {
+    if (body == NULL || len == NULL) {  // validate arguments
+        free(body);
+        return NULL;
+    }
+    if (encoding == NULL) {
+        return body;
+    }
+    while (*encoding == ' ' || *encoding == '\t') {
+        encoding++;
+    }
+    size_t codingLen = strcspn(encoding, " \t\r\n");
+    inflate_format_t format;
+    if (codingLen == 0 || (codingLen == 8 && strncasecmp(encoding, "identity", 8) == 0)) {
+        return body;
+    } else if ((codingLen == 4 && strncasecmp(encoding, "gzip", 4) == 0)
+               || (codingLen == 6 && strncasecmp(encoding, "x-gzip", 6) == 0)) {
+        format = INFLATE_GZIP;
+    } else if (codingLen == 7 && strncasecmp(encoding, "deflate", 7) == 0) {
+        format = INFLATE_DEFLATE;   // should be zlib wrapped, but some servers send raw deflate
+    } else {    // unknown, or several codings stacked
+        free(body);
+        return NULL;
+    }
+    char *decoded = inflateBuffer(format, body, *len, len);
+    free(body);
+    return decoded;
+}
+
+/* function to burst a normalized http url into its hostname, port and pathname */
+/* see http.h for more information */
+bool httpBurstURL(const char *url, char **hostname, int *port, char **pathname) {
+    if (url == NULL || hostname == NULL || port == NULL || pathname == NULL) {    // validate arguments
+        return false;
+    }
+    int length = strlen(url) + 1;
+    *hostname = mem_calloc(length, sizeof(char));
+    *pathname = mem_calloc(length + 1, sizeof(char));
+    if (*hostname == NULL || *pathname == NULL) {
+        mem_free(*hostname);
+        mem_free(*pathname);
+        return false;
+    }
+    **pathname = '/';
+    *port = HTTP_PORT;
+    // same url forms accepted by webpage_fetch
+    if (sscanf(url, "http://%[^:/]:%d/%s", *hostname, port, *pathname + 1) == 3
+        || sscanf(url, "http://%[^:/]:%d", *hostname, port) == 2
+        || sscanf(url, "http://%[^/]/%s", *hostname, *pathname + 1) >= 1) {
+        return true;
+    }
+    mem_free(*hostname);
+    mem_free(*pathname);
+    *hostname = *pathname = NULL;
+    return false;
+}
+
+/* function to open a connection to hostname:port, trying up to MAX_TRY times */
+static httpconn_t *connOpen(const char *hostname, const int port) {
+    struct sockaddr_in addr;
+    bool resolved = false;
+    int sock = -1;
+    for (int try = 0; sock < 0 && try < MAX_TRY; try++) {
+        if (resolved || (resolved = httpResolve(hostname, port, &addr))) {
+            sock = socket(AF_INET, SOCK_STREAM, 0);
+            if (sock >= 0 && connect(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+                close(sock);
+                sock = -1;
+            }
+        }
+        if (sock < 0 && try + 1 < MAX_TRY) {
+            sleep(1);   // back off before retrying a failed connect; politeness is left to the caller's scheduler
+        }
+    }
+    if (sock < 0) {
+        return NULL;
+    }
+    httpconn_t *conn = mem_malloc(sizeof(httpconn_t));
+    if (conn == NULL || (conn->hostname = strdup(hostname)) == NULL) {
+        mem_free(conn);
+        close(sock);
+        return NULL;
+    }
+    conn->fd = sock;
+    conn->port = port;
+    conn->start = conn->end = conn->received = 0;
+    conn->next = NULL;
+    return conn;
+}
+
+/* function to take an idle keep-alive connection to hostname:port from the cache */
+static httpconn_t *connTake(const char *hostname, const int port) {
+    pthread_mutex_lock(&idleLock);
+    httpconn_t *prev = NULL;
+    httpconn_t *conn = idleConns;
+    for (; conn != NULL; prev = conn, conn = conn->next) {
+        if (conn->port == port && strcmp(conn->hostname, hostname) == 0) {  // unlink it
+            if (prev == NULL) {
+                idleConns = conn->next;
+            } else {
+                prev->next = conn->next;
+            }
+            conn->next = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&idleLock);
+    return conn;
+}
+
+/* function to return a connection to the cache once its last response has been read in full */
+static void connPut(httpconn_t *conn) {
+    pthread_mutex_lock(&idleLock);
+    int idle = 0;
+    for (httpconn_t *c = idleConns; c != NULL; c = c->next) {
+        if (c->port == conn->port && strcmp(c->hostname, conn->hostname) == 0) {
+            idle++;
+        }
+    }
+    if (idle < HttpIdleLimit) {
+        conn->next = idleConns;
+        idleConns = conn;
+        conn = NULL;
+    }
+    pthread_mutex_unlock(&idleLock);
+    if (conn != NULL) {     // enough idle connections to this host already
+        connClose(conn);
+    }
+}
+
+/* function to close a connection and free it */
+static void connClose(httpconn_t *conn) {
+    close(conn->fd);
+    free(conn->hostname);
+    mem_free(conn);
+}
+
+/* function to send a GET request for pathname on a connection, conditional if validators are set */
+static bool connSendGet(httpconn_t *conn, const char *pathname, const http_validators_t *validators) {
+    int condLen = httpValidatorsFormat(validators, NULL, 0);
+    char conditional[condLen + 1];
+    httpValidatorsFormat(validators, conditional, condLen + 1);
+    const char *format = "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\nAccept-Encoding: gzip, deflate\r\n%s\r\n";
+    int len = snprintf(NULL, 0, format, pathname, conn->hostname, conditional);
+    char request[len + 1];
+    snprintf(request, len + 1, format, pathname, conn->hostname, conditional);
+    for (int sent = 0; sent < len; ) {
+        ssize_t n = send(conn->fd, request + sent, len - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+/* function to read the next line from a connection, dropping the CRLF */
+static int connReadLine(httpconn_t *conn, char *line) {
+    int len = 0;
+    for (;;) {
+        if (conn->start == conn->end) {     // refill the buffer
+            ssize_t n = recv(conn->fd, conn->buf, CONN_BUF, 0);
+            if (n <= 0) {
+                return -1;
+            }
+            conn->received += n;
+            conn->start = 0;
+            conn->end = n;
+        }
+        char c = conn->buf[conn->start++];
+        if (c == '\n') {
+            break;
+        }
+        if (len == MAX_LINE - 1) {
+            return -1;
+        }
+        line[len++] = c;
+    }
+    if (len > 0 && line[len - 1] == '\r') {
+        len--;
+    }
+    line[len] = '\0';
+    return len;
+}
+
+/* function to read one response from a connection */
+static int readResponse(httpconn_t *conn, char **body, bool *keepAlive, http_validators_t *validators) {
+    char line[MAX_LINE];
+    int minor, code;
+    *body = NULL;
+    if (connReadLine(conn, line) < 0) {
+        return RESPONSE_BROKEN;
+    }
+    if (sscanf(line, "HTTP/1.%d %d", &minor, &code) != 2) {
+        return RESPONSE_UNUSABLE;
+    }
+    // a 200 replaces the validators; a 304 only updates those it repeats
+    http_validators_t fresh = { NULL, NULL, false };
+    http_validators_t *target = validators == NULL ? NULL : code == 304 ? validators : code == 200 ? &fresh : NULL;
+    *keepAlive = (minor >= 1);  // HTTP/1.1 connections persist unless the server says otherwise
+    long contentLength = -1;
+    bool chunked = false;
+    char encoding[MAX_CODING] = "";
+    int len;
+    while ((len = connReadLine(conn, line)) > 0) {  // headers end with a blank line
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            contentLength = strtol(line + 15, NULL, 10);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            chunked = (strcasestr(line + 18, "chunked") != NULL);
+        } else if (strncasecmp(line, "Content-Encoding:", 17) == 0) {
+            snprintf(encoding, sizeof(encoding), "%s", line + 17);
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            if (strcasestr(line + 11, "close") != NULL) {
+                *keepAlive = false;
+            } else if (strcasestr(line + 11, "keep-alive") != NULL) {
+                *keepAlive = true;
+            }
+        } else if (target != NULL) {
+            httpValidatorsParse(target, line);
+        }
+    }
+    if (len < 0) {
+        httpValidatorsClear(&fresh);
+        return RESPONSE_BROKEN;
+    }
+    if ((code >= 100 && code < 200) || code == 204 || code == 304) {   // no body
+        httpValidatorsClear(&fresh);
+        return code;
+    }
+    if (!chunked && contentLength < 0) {    // body ends when the server closes the connection
+        *keepAlive = false;
+    }
+    size_t bodyLen = 0;
+    httpbody_t *reader = httpBodyNew(contentLength, chunked);
+    int read = reader == NULL ? -1 : readBody(conn, reader);    // no reader: over HttpBodyLimit or out of memory
+    if (read == 1) {
+        *body = httpBodyTake(reader, &bodyLen);
+    }
+    httpBodyDelete(reader);
+    if (*body == NULL) {    // the connection is out of step
+        httpValidatorsClear(&fresh);
+        return read == 0 ? RESPONSE_BROKEN : RESPONSE_UNUSABLE;
+    }
+    if (encoding[0] != '\0') {  // the whole body was read, so the connection stays usable even if this fails
+        *body = httpDecodeBody(encoding, *body, &bodyLen);
+    }
+    if (*body != NULL && target == &fresh) {     // the copy the caller keeps now matches these
+        httpValidatorsClear(validators);
+        *validators = fresh;
+    } else {
+        httpValidatorsClear(&fresh);
+    }
+    return code;
+}
+
+/* function to read a body from a connection, buffered bytes first */
+static int readBody(httpconn_t *conn, httpbody_t *body) {
+    for (;;) {
+        int status = httpBodyStatus(body);
+        if (status != 0) {
+            return status;
+        }
+        if (conn->start < conn->end) {  // bytes already read from the socket
+            conn->start += httpBodyFeed(body, conn->buf + conn->start, conn->end - conn->start);
+            continue;
+        }
+        size_t room;
+        char *space = httpBodySpace(body, &room);
+        ssize_t n = space != NULL ? recv(conn->fd, space, room, 0)    // data: straight into the body
+                                  : recv(conn->fd, conn->buf, CONN_BUF, 0);  // framing: through the buffer
+        if (n < 0) {
+            return 0;
+        } else if (n == 0) {
+            return httpBodyEnd(body) ? 1 : 0;
+        }
+        conn->received += n;
+        if (space != NULL) {
+            httpBodyCommit(body, n);
+        } else {
+            conn->start = 0;
+            conn->end = n;
+        }
+    }
+}
+
+/* function to replace a page with one holding the same url and depth and the given html */
+static bool pageAttach(webpage_t **page, char *html) {
+    char *url = strdup(webpage_getURL(*page));
+    webpage_t *fetched = url == NULL ? NULL : webpage_new(url, webpage_getDepth(*page), html);
+    if (fetched == NULL) {
+        free(url);
+        free(html);
+        return false;
+    }
+    webpage_delete(*page);
+    *page = fetched;
+    return true;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file http.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief http provides a thread-safe page fetcher that can be shared by the crawler's fetch workers
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __HTTP_H_
+#define __HTTP_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include <netinet/in.h>
+#include <webpage.h>
+
+/**
+ * @brief validators of a stored copy of a page: sent with a conditional fetch and refreshed from its response
+ *
+ */
+typedef struct httpValidators {
+    char *etag;             // ETag of the stored copy (malloc'd) or NULL
+    char *lastModified;     // Last-Modified of the stored copy (malloc'd) or NULL
+    bool notModified;       // set when a conditional fetch is answered with 304 Not Modified
+} http_validators_t;
+
+/**
+ * @brief function to fetch the html of a webpage; safe to call from several threads at once
+ *
+ * @param page pointer to webpage object pointer; the page must have a url and no html
+ * @return true if the page was fetched; *page then points to a new webpage holding the html
+ * @return false if the fetch failed; *page is left untouched
+ * do
+ *  - nothing if page or *page is NULL or *page already has html
+ *  - reuse an idle keep-alive connection to the host of the page, or open one
+ *    (resolved with getaddrinfo, not gethostbyname)
+ *  - send a GET request offering gzip and deflate and read the html of a 200 response, decoded
+ *  - replace *page with a webpage holding the same url and depth and the fetched html
+ */
+bool httpFetch(webpage_t **page);
+
+/**
+ * @brief function to fetch several pages of one host, pipelining the requests over one keep-alive connection
+ *
+ * @param pages array of n webpage pointers; pages not on the host of pages[0] are skipped
+ * @param n number of pages
+ * @return int number of pages fetched; each fetched pages[i] is replaced as in httpFetch
+ * do
+ *  - send every request, then read the responses in order (framed by Content-Length or chunked encoding)
+ *  - if the server closes the connection part way, send the remaining requests on a new one
+ *  - keep the connection for later fetches if the server allows it (at most HttpIdleLimit idle per host)
+ * same as httpFetchAllConditional(pages, n, NULL)
+ */
+int httpFetchAll(webpage_t **pages, const int n);
+
+/**
+ * @brief function to fetch several pages of one host as httpFetchAll does, asking the server to skip unchanged ones
+ *
+ * @param pages array of n webpage pointers
+ * @param n number of pages
+ * @param validators array of n validators, one per page (or NULL to fetch every page in full)
+ * @return int number of pages fetched or found not modified
+ * do
+ *  - send If-None-Match and If-Modified-Since with the request of every page whose validators are set
+ *  - on 304 set notModified and leave the page without html; the stored copy is still current
+ *  - on 200 or 304 replace the validators with the ETag and Last-Modified of the response
+ */
+int httpFetchAllConditional(webpage_t **pages, const int n, http_validators_t *validators);
+
+/**
+ * @brief function to write the conditional request headers for validators
+ *
+ * @param validators validators of the stored copy (may be NULL)
+ * @param buf buffer to write to
+ * @param size size of buf
+ * @return int number of bytes the headers take (as snprintf: they are cut short if that is size or more)
+ */
+int httpValidatorsFormat(const http_validators_t *validators, char *buf, const size_t size);
+
+/**
+ * @brief function to record a response header line in validators if it is an ETag or Last-Modified header
+ *
+ * @param validators validators to update
+ * @param line header line without its line ending
+ * @return true if the line was one of the two headers
+ */
+bool httpValidatorsParse(http_validators_t *validators, const char *line);
+
+/**
+ * @brief function to free the strings held by validators and reset them
+ *
+ * @param validators validators to clear (may be NULL)
+ */
+void httpValidatorsClear(http_validators_t *validators);
+
+/**
+ * @brief function to decode a response body according to its Content-Encoding header
+ *
+ * @param encoding value of the Content-Encoding header, up to the end of its line (NULL if none was sent)
+ * @param body malloc'd body as received, with a '\0' after it; freed here if it is replaced
+ * @param len pointer to the length of body; set to the length of the body returned
+ * @return char* body itself if it is not encoded, the decoded body (malloc'd, with a '\0' after it),
+ *         or NULL (body freed) if the encoding is not gzip or deflate or the body cannot be decoded
+ * requests sent by http and evfetch offer "Accept-Encoding: gzip, deflate", so any other coding is unexpected
+ */
+char *httpDecodeBody(const char *encoding, char *body, size_t *len);
+
+/**
+ * @brief function to send every fetch (of http and evfetch) to one address instead of resolving the host of the url
+ *
+ * @param target "address:port", e.g. "127.0.0.1:8080" for bench/tseserver, or NULL to resolve hosts again
+ * @return true if target was understood
+ * call before any fetch starts; the urls and the Host header sent are unchanged
+ */
+bool httpConnectTo(const char *target);
+
+/**
+ * @brief function to resolve hostname:port to an IPv4 address, or to give the address set with httpConnectTo
+ *
+ * @param hostname host to resolve (with getaddrinfo, so safe from several threads)
+ * @param port port to connect to
+ * @param addr pointer to store the address
+ * @return true if the host was resolved
+ */
+bool httpResolve(const char *hostname, const int port, struct sockaddr_in *addr);
+
+/**
+ * @brief function to close every idle keep-alive connection; call once no fetch is running
+ *
+ */
+void httpCleanup(void);
+
+/**
+ * @brief function to burst a normalized http url into its hostname, port and pathname
+ *
+ * @param url url to burst
+ * @param hostname pointer to char pointer to store the hostname (caller frees)
+ * @param port pointer to int to store the port
+ * @param pathname pointer to char pointer to store the pathname (caller frees)
+ * @return true if the url could be burst
+ * @return false if the url is not of the form http://host[:port][/pathname]
+ */
+bool httpBurstURL(const char *url, char **hostname, int *port, char **pathname);
+
+#endif
@@ -0,0 +1,279 @@
+/**
+ * @file httpbody.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in httpbody.h (a reader for http response bodies)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include "httpbody.h"
+#include "mem.h"
+
+enum { MAX_LINE = 8192 };           // longest chunk size or trailer line accepted
+enum { SIZE_LINE = 64 };            // bytes of a chunk size line kept (the size comes first; extensions are ignored)
+static const size_t EOF_READ = 16384;   // room made for each read of a body framed by the end of the connection
+
+/**
+ * @brief where the reader is in the framing of the body
+ *
+ */
+typedef enum bodyState {
+    BODY_DATA,      // body (or chunk) data
+    BODY_SIZE,      // chunk size line
+    BODY_DATA_END,  // CRLF after the data of a chunk
+    BODY_TRAILER,   // trailer lines after the last chunk, up to a blank line
+    BODY_DONE,      // body whole
+    BODY_ERROR      // malformed framing or body too large
+} body_state_t;
+
+/**
+ * @brief the body read so far and where the reader is in its framing
+ *
+ */
+struct httpbody {
+    char *data;             // body data (malloc'd) or NULL
+    size_t len;             // bytes of data
+    size_t cap;             // size of data, less the byte kept for the '\0'
+    long remaining;         // data bytes due: of the body, or of the current chunk; -1 if the body ends with the connection
+    bool chunked;           // true for a chunked body
+    body_state_t state;     // where the reader is
+    size_t lineLen;         // length of the framing line read so far
+    char last;              // last byte of the framing line read so far
+    char line[SIZE_LINE];   // start of the framing line read so far
+};
+
+/**
+ * @brief function to make room for n more bytes of data
+ *
+ * @param body reader
+ * @param n number of bytes
+ * @return true if there is room
+ * @return false if out of memory or the body would pass HttpBodyLimit (the reader is then in error)
+ */
+static bool reserve(httpbody_t *body, const size_t n);
+
+/**
+ * @brief function to account for n bytes of data added to the body
+ *
+ * @param body reader
+ * @param n number of bytes
+ */
+static void dataAdded(httpbody_t *body, const size_t n);
+
+/**
+ * @brief function to act on a whole framing line: a chunk size, the end of a chunk, or a trailer
+ *
+ * @param body reader
+ */
+static void lineEnd(httpbody_t *body);
+
+/* see httpbody.h for more information */
+httpbody_t *httpBodyNew(const long contentLength, const bool chunked) {
+    // validate arguments
+    if (!chunked && contentLength > HttpBodyLimit) {
+        return NULL;
+    }
+    httpbody_t *body = mem_calloc(1, sizeof(httpbody_t));
+    if (body == NULL) {
+        return NULL;
+    }
+    body->chunked = chunked;
+    if (chunked) {
+        body->state = BODY_SIZE;
+    } else if (contentLength >= 0) {    // exact size known: allocate it once
+        body->state = contentLength == 0 ? BODY_DONE : BODY_DATA;
+        body->remaining = contentLength;
+        if (!reserve(body, contentLength)) {
+            httpBodyDelete(body);
+            return NULL;
+        }
+    } else {    // read until the connection ends
+        body->state = BODY_DATA;
+        body->remaining = -1;
+    }
+    return body;
+}
+
+/* see httpbody.h for more information */
+size_t httpBodyFeed(httpbody_t *body, const char *buf, const size_t n) {
+    // validate arguments
+    if (body == NULL || buf == NULL) {
+        return 0;
+    }
+    size_t used = 0;
+    while (used < n && body->state != BODY_DONE && body->state != BODY_ERROR) {
+        if (body->state == BODY_DATA) {     // copy as much data as is due
+            size_t k = n - used;
+            if (body->remaining >= 0 && k > (size_t) body->remaining) {
+                k = body->remaining;
+            }
+            if (!reserve(body, k)) {
+                break;
+            }
+            memcpy(body->data + body->len, buf + used, k);
+            used += k;
+            dataAdded(body, k);
+            continue;
+        }
+        char c = buf[used++];   // a framing line, one byte at a time
+        if (c == '\n') {
+            lineEnd(body);
+            continue;
+        }
+        if (body->lineLen < SIZE_LINE - 1) {
+            body->line[body->lineLen] = c;
+        }
+        body->last = c;
+        if (++body->lineLen > MAX_LINE) {
+            body->state = BODY_ERROR;
+        }
+    }
+    return used;
+}
+
+/* see httpbody.h for more information */
+char *httpBodySpace(httpbody_t *body, size_t *n) {
+    // validate arguments
+    if (body == NULL || n == NULL || body->state != BODY_DATA) {
+        return NULL;
+    }
+    if (body->remaining < 0) {  // no size known: make room for another read
+        if (!reserve(body, EOF_READ)) {
+            return NULL;
+        }
+        *n = body->cap - body->len;
+    } else {    // room for what is due was made when the size was read
+        if (!reserve(body, body->remaining)) {
+            return NULL;
+        }
+        *n = body->remaining;
+    }
+    return body->data + body->len;
+}
+
+/* see httpbody.h for more information */
+void httpBodyCommit(httpbody_t *body, const size_t n) {
+    if (body != NULL && body->state == BODY_DATA && body->len + n <= body->cap) {
+        dataAdded(body, n);
+    }
+}
+
+/* see httpbody.h for more information */
+bool httpBodyEnd(httpbody_t *body) {
+    if (body == NULL) {
+        return false;
+    }
+    if (body->state == BODY_DATA && body->remaining < 0) {  // the end of the connection is the end of the body
+        body->state = BODY_DONE;
+    }
+    if (body->state != BODY_DONE) {
+        body->state = BODY_ERROR;
+    }
+    return body->state == BODY_DONE;
+}
+
+/* see httpbody.h for more information */
+int httpBodyStatus(const httpbody_t *body) {
+    if (body == NULL || body->state == BODY_ERROR) {
+        return -1;
+    }
+    return body->state == BODY_DONE ? 1 : 0;
+}
+
+/* see httpbody.h for more information */
+char *httpBodyTake(httpbody_t *body, size_t *len) {
+    if (body == NULL || body->state != BODY_DONE || (body->data == NULL && !reserve(body, 0))) {
+        return NULL;
+    }
+    char *data = body->data;
+    data[body->len] = '\0';
+    if (len != NULL) {
+        *len = body->len;
+    }
+    body->data = NULL;
+    body->len = body->cap = 0;
+    return data;
+}
+
+/* see httpbody.h for more information */
+void httpBodyDelete(httpbody_t *body) {
+    if (body == NULL) {
+        return;
+    }
+    free(body->data);
+    mem_free(body);
+}
+
+/* function to make room for n more bytes of data */
+static bool reserve(httpbody_t *body, const size_t n) {
+    if (body->data != NULL && body->cap - body->len >= n) {
+        return true;
+    }
+    if (body->len + n > (size_t) HttpBodyLimit) {
+        body->state = BODY_ERROR;
+        return false;
+    }
+    size_t cap = body->len + n;
+    if (body->remaining < 0 || body->chunked) {     // size not known up front: grow geometrically
+        if (cap < 2 * body->cap) {
+            cap = 2 * body->cap;
+        }
+        if (cap > (size_t) HttpBodyLimit) {
+            cap = HttpBodyLimit;
+        }
+    }
+    char *data = realloc(body->data, cap + 1);  // + 1 for the '\0'
+    if (data == NULL) {
+        body->state = BODY_ERROR;
+        return false;
+    }
+    body->data = data;
+    body->cap = cap;
+    return true;
+}
+
+/* function to account for n bytes of data added to the body */
+static void dataAdded(httpbody_t *body, const size_t n) {
+    body->len += n;
+    if (body->remaining < 0) {  // ends with the connection
+        return;
+    }
+    body->remaining -= n;
+    if (body->remaining == 0) {
+        body->state = body->chunked ? BODY_DATA_END : BODY_DONE;
+    }
+}
+
+/* function to act on a whole framing line */
+static void lineEnd(httpbody_t *body) {
+    size_t len = body->lineLen;
+    if (len > 0 && body->last == '\r') {
+        len--;
+    }
+    body->line[len < SIZE_LINE - 1 ? len : SIZE_LINE - 1] = '\0';
+    body->lineLen = 0;
+    body->last = '\0';
+    if (body->state == BODY_SIZE) {     // hex size, then optional extensions
+        char *end;
+        long size = strtol(body->line, &end, 16);
+        if (!isxdigit((unsigned char) body->line[0]) || size < 0 || (*end != '\0' && *end != ';' && *end != ' ')) {
+            body->state = BODY_ERROR;
+        } else if (size == 0) {     // last chunk
+            body->state = BODY_TRAILER;
+        } else if (reserve(body, size)) {
+            body->remaining = size;
+            body->state = BODY_DATA;
+        }
+    } else if (body->state == BODY_DATA_END) {  // data must be followed by an empty line
+        body->state = len == 0 ? BODY_SIZE : BODY_ERROR;
+    } else if (body->state == BODY_TRAILER && len == 0) {
+        body->state = BODY_DONE;
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file httpbody.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief httpbody provides a reader for http response bodies framed by Content-Length, chunked encoding or the end of the connection
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __HTTP_BODY_H_
+#define __HTTP_BODY_H_
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef HttpBodyLimit
+#define HttpBodyLimit (64L << 20) // largest body accepted, whatever the framing says
+#endif
+
+/**
+ * @brief opaque type holding the body read so far and where the reader is in its framing
+ *
+ */
+typedef struct httpbody httpbody_t;
+
+/**
+ * @brief function to start reading a body once the headers of its response are read
+ *
+ * @param contentLength value of the Content-Length header, or -1 if none was sent
+ * @param chunked true if the response was sent with Transfer-Encoding: chunked (which overrides Content-Length)
+ * @return httpbody_t* new reader or NULL on failure or if contentLength is over HttpBodyLimit
+ * do
+ *  - for a Content-Length body allocate the exact size at once
+ *  - for a chunked body grow the buffer once per chunk, to the size the chunk announces
+ *  - otherwise read until httpBodyEnd, doubling the buffer as it fills
+ */
+httpbody_t *httpBodyNew(const long contentLength, const bool chunked);
+
+/**
+ * @brief function to pass bytes read from the connection to the reader
+ *
+ * @param body reader
+ * @param buf bytes read after the headers (or after the bytes already passed)
+ * @param n number of bytes
+ * @return size_t number of bytes used; bytes past the end of the body are left for the next response
+ */
+size_t httpBodyFeed(httpbody_t *body, const char *buf, const size_t n);
+
+/**
+ * @brief function to get the buffer the next bytes of body data can be received straight into
+ *
+ * @param body reader
+ * @param n pointer to store the number of bytes that may be received into the buffer (never past the body)
+ * @return char* where to receive, or NULL if the next bytes are framing (a chunk size line) and must go through httpBodyFeed
+ * after receiving into it, call httpBodyCommit with the number of bytes received
+ */
+char *httpBodySpace(httpbody_t *body, size_t *n);
+
+/**
+ * @brief function to account for bytes received into the buffer given by httpBodySpace
+ *
+ * @param body reader
+ * @param n number of bytes received (at most what httpBodySpace allowed)
+ */
+void httpBodyCommit(httpbody_t *body, const size_t n);
+
+/**
+ * @brief function to tell the reader that the connection has closed
+ *
+ * @param body reader
+ * @return true if the body is whole (always, for a body framed by the end of the connection)
+ * @return false if the body was cut short
+ */
+bool httpBodyEnd(httpbody_t *body);
+
+/**
+ * @brief function to check whether the body is whole
+ *
+ * @param body reader
+ * @return int 1 if the body is whole, 0 if more bytes are needed, -1 if the framing is malformed or the body too large
+ */
+int httpBodyStatus(const httpbody_t *body);
+
+/**
+ * @brief function to take the body from the reader
+ *
+ * @param body reader of a whole body
+ * @param len pointer to store the length of the body (may be NULL)
+ * @return char* the body (malloc'd, with a '\0' after it), or NULL if the body is not whole; the reader keeps nothing
+ */
+char *httpBodyTake(httpbody_t *body, size_t *len);
+
+/**
+ * @brief function to delete a reader and any body it still holds
+ *
+ * @param body reader (may be NULL)
+ */
+void httpBodyDelete(httpbody_t *body);
+
+#endif
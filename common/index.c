@@ -12,6 +12,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "word.h"
@@ -21,6 +22,7 @@
 #include "mem.h"
 #include "index.h"
 #include "file.h"
+#include "crc.h"
 
 
 /**
@@ -50,6 +52,219 @@ static void printCounter(void *fp, const int key, const int value);
  */
 static char *getWordInLine(const char *line, int *pos);
 
+/**
+ * @brief function to add the counters of a word to the index passed as arg, using iterate
+ * 
+ * @param arg merge_arg_t of the index to update
+ * @param key word
+ * @param value counters of the word
+ */
+static void mergeRow(void *arg, const char *key, void *value);
+
+/**
+ * @brief function to add a count to the counters passed as arg, using iterate
+ * 
+ * @param arg merge_arg_t holding the counters of the word
+ * @param key doc id
+ * @param value count
+ */
+static void mergeCount(void *arg, const int key, const int value);
+
+/**
+ * @brief arguments passed through iterate when merging indexes
+ * 
+ */
+typedef struct mergeArg {
+    index_t *index;         // index being updated
+    counters_t *counters;   // counters of the word being merged, in index
+    bool failed;            // set if an update failed
+} merge_arg_t;
+
+/**
+ * @brief a word of an index and its counters, gathered to be sorted
+ * 
+ */
+typedef struct indexRow {
+    const char *word;       // word, as held by the index
+    counters_t *counters;   // counters of the word
+} index_row_t;
+
+/**
+ * @brief arguments passed through iterate when gathering the rows of an index
+ * 
+ */
+typedef struct rowsArg {
+    index_row_t *rows;      // rows gathered
+    size_t count;           // rows in rows
+    size_t capacity;        // room in rows
+    bool failed;            // set if rows could not grow
+} rows_arg_t;
+
+/**
+ * @brief the line of a run being merged
+ * 
+ */
+typedef struct runLine {
+    FILE *fp;       // run being read
+    int run;        // position of the run, for words in more than one
+    char *line;     // current line, cut after its word: the word, then '\0'
+    char *rest;     // the docIDs and counts after the word, each pair with a space before it
+} run_line_t;
+
+enum { MAGIC_LEN = 8, HEADER = 48 };  // binary index header: see indexSaveBinary in index.h
+
+/**
+ * @brief a docID and count of a word, gathered to be written in binary
+ * 
+ */
+typedef struct posting {
+    int docID;      // doc id
+    int count;      // times the word is in the doc
+} posting_t;
+
+/**
+ * @brief postings gathered for a word
+ * 
+ */
+typedef struct postings {
+    posting_t *items;   // postings gathered
+    size_t count;       // postings in items
+    size_t capacity;    // room in items
+    bool failed;        // set if items could not grow
+} postings_t;
+
+/**
+ * @brief a growing byte buffer
+ * 
+ */
+typedef struct bytes {
+    unsigned char *data;    // bytes
+    size_t len;             // bytes used
+    size_t capacity;        // room in data
+} bytes_t;
+
+/**
+ * @brief a binary index file being written, a word at a time in dictionary order
+ * 
+ */
+typedef struct binaryWriter {
+    FILE *fp;               // file being written, the header left blank until the end
+    bytes_t block;          // postings of the word being written
+    bytes_t dict;           // dictionary, written after the postings
+    char *last;             // word written before, for the bytes a word shares with it
+    size_t lastCap;         // room in last
+    uint64_t postings;      // postings written
+    uint64_t postingsBytes; // size of the postings written
+    uint32_t words;         // words written
+    uint32_t postingsCrc;   // crc32 of the postings written
+    bool failed;            // set if anything could not be written
+} binary_writer_t;
+
+/**
+ * @brief function to start a binary index file
+ * 
+ * @return bool false if the file cannot be opened
+ */
+static bool writerOpen(binary_writer_t *writer, const char *fn);
+
+/**
+ * @brief function to write a word and its postings to a binary index file; words must come in strcmp order
+ * 
+ * @param postings postings of the word, sorted here by docID
+ */
+static void writerWord(binary_writer_t *writer, const char *word, postings_t *postings);
+
+/**
+ * @brief function to write the dictionary and header of a binary index file and close it
+ * 
+ * @return int 0 if success ; -1 if failure
+ */
+static int writerClose(binary_writer_t *writer);
+
+/**
+ * @brief function to add a posting to the postings_t passed as arg, using iterate
+ * 
+ */
+static void collectPosting(void *arg, const int key, const int value);
+
+/**
+ * @brief function to add the postings of a line of an index file, " docID count" pairs, to postings
+ * 
+ */
+static void parsePostings(const char *rest, postings_t *postings);
+
+/**
+ * @brief function to order postings by docID, for qsort
+ * 
+ */
+static int comparePostings(const void *a, const void *b);
+
+/**
+ * @brief function to add bytes to a buffer, growing it as needed
+ * 
+ * @return bool false if the buffer could not grow
+ */
+static bool bytesAdd(bytes_t *bytes, const void *data, const size_t len);
+
+/**
+ * @brief function to add a varint (7 bits a byte, low bits first) to a buffer
+ * 
+ */
+static bool bytesVarint(bytes_t *bytes, uint64_t value);
+
+/**
+ * @brief function to read a varint, moving p past it
+ * 
+ * @return bool false if it runs past end or over 64 bits
+ */
+static bool getVarint(const unsigned char **p, const unsigned char *end, uint64_t *value);
+
+/**
+ * @brief functions to write and read little endian integers
+ * 
+ */
+static void putLE(unsigned char *buf, uint64_t value, const int bytes);
+static uint64_t getLE(const unsigned char *buf, const int bytes);
+
+/**
+ * @brief function to add a row to the rows_arg_t passed as arg, using iterate
+ * 
+ * @param arg rows_arg_t to add to
+ * @param key word
+ * @param value counters of the word
+ */
+static void collectRow(void *arg, const char *key, void *value);
+
+/**
+ * @brief function to order rows by word, for qsort
+ * 
+ */
+static int compareRows(const void *a, const void *b);
+
+/**
+ * @brief function to read the next line of a run into its run_line_t
+ * 
+ * @param run run to read from
+ * @return true if a line was read
+ * @return false at the end of the run (or on a line without a word)
+ */
+static bool runNext(run_line_t *run);
+
+/**
+ * @brief function to tell if one run line goes before another: by word, then by run
+ * 
+ */
+static bool runBefore(const run_line_t *a, const run_line_t *b);
+
+/**
+ * @brief function to move the run line at position i of a heap down to where it belongs
+ * 
+ * @param heap binary heap of run lines, least first
+ * @param count lines in heap
+ * @param i position to sift down from
+ */
+static void runSift(run_line_t **heap, const int count, int i);
+
 /* */
 /* see index.h for more information */
 typedef struct hashtable index_t;
@@ -72,6 +287,15 @@ int indexAdd(index_t *index, const char *word, const int docID) {
     if (normalizeWord((char *) word) != 0) {    // normalize word
         return -1;
     }
+    return indexAddLower(index, word, docID, NULL);
+}
+
+/* function to insert/update a lower case word in an index */
+/* see index.h for more information */
+int indexAddLower(index_t *index, const char *word, const int docID, size_t *bytes) {
+    if (index == NULL || word  == NULL || docID < 1) {  // validate arguments
+        return -1;
+    }
     hashtable_t *table = (hashtable_t *) index; // cast index into hashtable
     counters_t *counters = (counters_t *) hashtable_find(table, word);  // find the counters for word in index
     bool insertAfter = false;
@@ -82,7 +306,8 @@ int indexAdd(index_t *index, const char *word, const int docID) {
         }
         insertAfter = true;     // flag to insert counter into table
     }
-    if (counters_add(counters, docID) < 1) {    // add docid instance to counters
+    int count = counters_add(counters, docID);  // add docid instance to counters
+    if (count < 1) {
         return -1;
     }
     if (insertAfter) {
@@ -90,6 +315,9 @@ int indexAdd(index_t *index, const char *word, const int docID) {
             return -1;
         }
     }
+    if (bytes != NULL) {    // account for what the index grew by
+        *bytes += (count == 1 ? IndexPostingBytes : 0) + (insertAfter ? IndexWordBytes + strlen(word) : 0);
+    }
     return 0;
 }
 
@@ -136,17 +364,247 @@ int indexUpdate(index_t *index, const char *word, const int docID, const int fre
 }
 
 
+/* function to add the counts of another index into an index */
+/* see index.h for more information */
+int indexMerge(index_t *index, index_t *other) {
+    if (index == NULL || other == NULL) {   // validate args
+        return -1;
+    }
+    merge_arg_t arg = { index, NULL, false };
+    hashtable_iterate((hashtable_t *) other, &arg, mergeRow);
+    return arg.failed ? -1 : 0;
+}
+
+/* function to save an index with its words sorted */
+/* see index.h for more information */
+int indexSaveSorted(index_t *index, const char *fn) {
+    if (index == NULL || fn == NULL) {  // validate arguments
+        return -1;
+    }
+    rows_arg_t arg = { NULL, 0, 0, false };
+    hashtable_iterate((hashtable_t *) index, &arg, collectRow);  // gather the rows to sort them
+    FILE *fp = arg.failed ? NULL : fopen(fn, "w");
+    if (fp == NULL) {
+        free(arg.rows);
+        return -1;
+    }
+    if (arg.count > 0) {
+        qsort(arg.rows, arg.count, sizeof(index_row_t), compareRows);
+    }
+    for (size_t i = 0; i < arg.count; i++) {    // write the rows as indexSave would
+        printIndexRow(fp, arg.rows[i].word, arg.rows[i].counters);
+    }
+    free(arg.rows);
+    int failed = ferror(fp);
+    return (fclose(fp) | failed) == 0 ? 0 : -1;
+}
+
+/* function to save an index in binary */
+/* see index.h for more information */
+int indexSaveBinary(index_t *index, const char *fn) {
+    if (index == NULL || fn == NULL) {  // validate arguments
+        return -1;
+    }
+    rows_arg_t arg = { NULL, 0, 0, false };
+    hashtable_iterate((hashtable_t *) index, &arg, collectRow);  // gather the rows to sort them
+    binary_writer_t writer;
+    if (arg.failed || !writerOpen(&writer, fn)) {
+        free(arg.rows);
+        return -1;
+    }
+    if (arg.count > 0) {
+        qsort(arg.rows, arg.count, sizeof(index_row_t), compareRows);
+    }
+    postings_t postings = { NULL, 0, 0, false };
+    for (size_t i = 0; i < arg.count; i++) {    // each word with its postings, in dictionary order
+        postings.count = 0;
+        counters_iterate(arg.rows[i].counters, &postings, collectPosting);
+        writerWord(&writer, arg.rows[i].word, &postings);
+    }
+    free(arg.rows);
+    free(postings.items);
+    return writerClose(&writer) == 0 && !postings.failed ? 0 : -1;
+}
+
+/* function to load an index saved in binary */
+/* see index.h for more information */
+index_t *indexLoadBinary(const char *fn) {
+    if (fn == NULL) {   // validate arguments
+        return NULL;
+    }
+    FILE *fp = fopen(fn, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    unsigned char *file = NULL;
+    long len = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    if (len >= HEADER && fseek(fp, 0, SEEK_SET) == 0 && (file = malloc(len)) != NULL
+                                                    && fread(file, 1, len, fp) != (size_t) len) {
+        free(file);
+        file = NULL;
+    }
+    fclose(fp);
+    if (file == NULL) {
+        return NULL;
+    }
+    uint64_t postingCount = getLE(file + 8, 8), postingsBytes = getLE(file + 16, 8), dictBytes = getLE(file + 24, 8);
+    uint32_t words = getLE(file + 32, 4);
+    const unsigned char *postings = file + HEADER, *dict = postings + postingsBytes;
+    // the header must be whole, and the postings and dictionary must fill the rest of the file and match their crcs
+    if (memcmp(file, IndexMagic, MAGIC_LEN) != 0 || getLE(file + 44, 4) != crc32(0, file, 44)
+            || postingsBytes > (uint64_t) len - HEADER || dictBytes != (uint64_t) len - HEADER - postingsBytes
+            || getLE(file + 36, 4) != crc32(0, postings, postingsBytes)
+            || getLE(file + 40, 4) != crc32(0, dict, dictBytes)) {
+        free(file);
+        return NULL;
+    }
+    index_t *index = indexInit(words > IndexCoeff ? words : IndexCoeff);    // a slot per word: short chains
+    char *word = NULL;  // word being read, rebuilt from the one before it
+    size_t wordLen = 0, wordCap = 0;
+    const unsigned char *dictEnd = dict + dictBytes, *postingsEnd = dict;
+    uint64_t read = 0;
+    bool ok = index != NULL;
+    for (uint32_t w = 0; ok && w < words; w++) {
+        uint64_t shared, suffix, count, size;
+        ok = getVarint(&dict, dictEnd, &shared) && getVarint(&dict, dictEnd, &suffix) && shared <= wordLen
+                && suffix <= (uint64_t) (dictEnd - dict) && shared + suffix > 0;
+        if (ok && shared + suffix + 1 > wordCap) {  // grow the word
+            char *grown = realloc(word, 2 * (shared + suffix + 1));
+            ok = grown != NULL;
+            word = ok ? grown : word;
+            wordCap = ok ? 2 * (shared + suffix + 1) : wordCap;
+        }
+        if (!ok) {
+            break;
+        }
+        memcpy(word + shared, dict, suffix);
+        dict += suffix;
+        wordLen = shared + suffix;
+        word[wordLen] = '\0';
+        ok = getVarint(&dict, dictEnd, &count) && getVarint(&dict, dictEnd, &size)
+                && size <= (uint64_t) (postingsEnd - postings) && count > 0 && count <= size;
+        counters_t *counters = ok ? counters_new() : NULL;
+        if (counters == NULL || !hashtable_insert(index, word, counters)) {  // also fails on a repeated word
+            counters_delete(counters);
+            ok = false;
+            break;
+        }
+        const unsigned char *end = postings + size;
+        uint64_t docID = 0, delta, freq = 1;
+        for (uint64_t i = 0; ok && i < count; i++) {    // docIDs from their differences
+            ok = getVarint(&postings, end, &delta) && ((delta & 1) == 0 || getVarint(&postings, end, &freq));
+            freq = (delta & 1) == 0 ? 1 : freq + 2;
+            delta >>= 1;
+            ok = ok && (delta > 0 || i == 0) && (docID += delta) >= 1 && docID <= INT32_MAX && freq <= INT32_MAX
+                    && counters_set(counters, (int) docID, (int) freq);
+        }
+        ok = ok && postings == end;
+        read += count;
+    }
+    free(word);
+    free(file);
+    if (!ok || read != postingCount || dict != dictEnd || postings != postingsEnd) {
+        indexDelete(index);
+        return NULL;
+    }
+    return index;
+}
+
+/* function to merge sorted index files into one */
+/* see index.h for more information */
+int indexMergeRuns(const char *runs[], const int count, const char *fn, const bool binary) {
+    if (runs == NULL || count < 0 || fn == NULL) {  // validate arguments
+        return -1;
+    }
+    run_line_t *lines = calloc(count + 1, sizeof(run_line_t));
+    run_line_t **heap = calloc(count + 1, sizeof(run_line_t *));
+    binary_writer_t writer;
+    postings_t postings = { NULL, 0, 0, false };
+    FILE *fp = NULL;
+    if (lines != NULL && heap != NULL) {
+        fp = !binary ? fopen(fn, "w") : writerOpen(&writer, fn) ? writer.fp : NULL;
+    }
+    int heapCount = 0, status = fp == NULL ? -1 : 0;
+    for (int i = 0; status == 0 && i < count; i++) {    // open every run and read its first line
+        lines[i].run = i;
+        lines[i].fp = fopen(runs[i], "r");
+        if (lines[i].fp == NULL) {
+            status = -1;
+        } else if (runNext(&lines[i])) {
+            heap[heapCount++] = &lines[i];
+        }
+    }
+    for (int i = heapCount / 2 - 1; i >= 0; i--) {
+        runSift(heap, heapCount, i);
+    }
+    while (status == 0 && heapCount > 0) {  // write the least word, with the docIDs of every run it is in
+        char *word = heap[0]->line;     // kept while the runs holding it move on
+        if (!binary) {
+            fprintf(fp, "%s ", word);
+        }
+        postings.count = 0;
+        while (heapCount > 0 && (heap[0]->line == word || strcmp(heap[0]->line, word) == 0)) {
+            run_line_t *top = heap[0];
+            char *done = top->line;
+            if (binary) {
+                parsePostings(top->rest, &postings);
+            } else {
+                fputs(top->rest, fp);
+            }
+            if (!runNext(top)) {    // the run is done: the last line of the heap takes its place
+                heap[0] = heap[--heapCount];
+            }
+            runSift(heap, heapCount, 0);
+            if (done != word) {
+                mem_free(done);
+            }
+        }
+        if (binary) {
+            writerWord(&writer, word, &postings);
+        } else {
+            fprintf(fp, "\n");
+        }
+        mem_free(word);
+    }
+    for (int i = 0; i < count && lines != NULL; i++) {
+        if (lines[i].fp != NULL) {
+            fclose(lines[i].fp);
+        }
+        if (lines[i].line != NULL) {
+            mem_free(lines[i].line);
+        }
+    }
+    free(lines);
+    free(heap);
+    free(postings.items);
+    if (fp != NULL && binary) {
+        status = writerClose(&writer) == 0 && !postings.failed ? status : -1;
+    } else if (fp != NULL) {
+        int failed = ferror(fp);
+        status = (fclose(fp) | failed) == 0 ? status : -1;
+    }
+    return status;
+}
+
 /* function to load an index from a file */
 /* see index.h for more information */
 index_t *indexLoad(const char* fn) {
     if (fn == NULL) {   // validate arguments
         return NULL;
     }
+    FILE *fp = fopen(fn, "r");  // open file in read mode
+    char magic[MAGIC_LEN];
+    if (fp != NULL && fread(magic, 1, MAGIC_LEN, fp) == MAGIC_LEN && memcmp(magic, IndexMagic, MAGIC_LEN) == 0) {
+        fclose(fp);     // saved by indexSaveBinary
+        return indexLoadBinary(fn);
+    }
+    if (fp != NULL) {
+        rewind(fp);
+    }
     index_t *index = indexInit(IndexCoeff); // get and index
     if (index == NULL) {
         return NULL;
     }
-    FILE *fp = fopen(fn, "r");  // open file in read mode
     if (fp == NULL) {
     }
     char *line;
@@ -249,6 +707,48 @@ static void printCounter(void *fp, const int key, const int value) {
     fprintf(fp, " %d %d", key, value);  // write values to file
 }
 
+/**
+ * @brief function to add the counters of a word to the index passed as arg, using iterate
+ * 
+ * @param arg merge_arg_t of the index to update
+ * @param key word
+ * @param value counters of the word
+ */
+static void mergeRow(void *arg, const char *key, void *value) {
+    merge_arg_t *merge = arg;
+    if (merge == NULL || key == NULL || value == NULL) {    // validate arguments
+        return;
+    }
+    hashtable_t *table = (hashtable_t *) merge->index;
+    merge->counters = hashtable_find(table, key);
+    if (merge->counters == NULL) {  // a word new to index: give it counters of its own
+        merge->counters = counters_new();
+        if (merge->counters == NULL || !hashtable_insert(table, key, merge->counters)) {
+            counters_delete(merge->counters);
+            merge->failed = true;
+            return;
+        }
+    }
+    counters_iterate((counters_t *) value, merge, mergeCount);
+}
+
+/**
+ * @brief function to add a count to the counters passed as arg, using iterate
+ * 
+ * @param arg merge_arg_t holding the counters of the word
+ * @param key doc id
+ * @param value count
+ */
+static void mergeCount(void *arg, const int key, const int value) {
+    merge_arg_t *merge = arg;
+    if (merge == NULL || key < 1 || value < 1) {    // validate arguments
+        return;
+    }
+    if (!counters_set(merge->counters, key, counters_get(merge->counters, key) + value)) {
+        merge->failed = true;
+    }
+}
+
 /**
  * @brief Get the next word in null terminated string line object starting from pos
  * 
@@ -288,3 +788,246 @@ static char *getWordInLine(const char *line, int *pos) {
     *pos = end; // update value of pos to current word end
     return token;   // return token
 }
+
+/* function to add a row to the rows_arg_t passed as arg, using iterate */
+static void collectRow(void *arg, const char *key, void *value) {
+    rows_arg_t *rows = arg;
+    if (rows == NULL || key == NULL || value == NULL || rows->failed) {    // validate arguments
+        return;
+    }
+    if (rows->count == rows->capacity) {    // grow the rows
+        size_t capacity = rows->capacity == 0 ? 1024 : 2 * rows->capacity;
+        index_row_t *grown = realloc(rows->rows, capacity * sizeof(index_row_t));
+        if (grown == NULL) {
+            rows->failed = true;
+            return;
+        }
+        rows->rows = grown;
+        rows->capacity = capacity;
+    }
+    rows->rows[rows->count++] = (index_row_t) { key, value };
+}
+
+/* function to order rows by word */
+static int compareRows(const void *a, const void *b) {
+    return strcmp(((const index_row_t *) a)->word, ((const index_row_t *) b)->word);
+}
+
+/* function to read the next line of a run */
+static bool runNext(run_line_t *run) {
+    run->line = file_readLine(run->fp);
+    if (run->line == NULL) {
+        return false;
+    }
+    char *space = strchr(run->line, ' ');
+    if (space == NULL) {    // not a line indexSave writes
+        mem_free(run->line);
+        run->line = NULL;
+        return false;
+    }
+    *space = '\0';
+    run->rest = space + 1;
+    return true;
+}
+
+/* function to tell if one run line goes before another */
+static bool runBefore(const run_line_t *a, const run_line_t *b) {
+    int order = strcmp(a->line, b->line);
+    return order < 0 || (order == 0 && a->run < b->run);
+}
+
+/* function to sift a run line down a heap */
+static void runSift(run_line_t **heap, const int count, int i) {
+    while (2 * i + 1 < count) {
+        int child = 2 * i + 1;
+        if (child + 1 < count && runBefore(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!runBefore(heap[child], heap[i])) {
+            return;
+        }
+        run_line_t *swap = heap[i];
+        heap[i] = heap[child];
+        heap[child] = swap;
+        i = child;
+    }
+}
+
+/* function to start a binary index file */
+static bool writerOpen(binary_writer_t *writer, const char *fn) {
+    memset(writer, 0, sizeof(binary_writer_t));
+    writer->fp = fopen(fn, "wb");
+    unsigned char header[HEADER] = { 0 };   // written once the sizes are known
+    if (writer->fp == NULL || fwrite(header, 1, HEADER, writer->fp) != HEADER) {
+        if (writer->fp != NULL) {
+            fclose(writer->fp);
+        }
+        return false;
+    }
+    return true;
+}
+
+/* function to write a word and its postings to a binary index file */
+static void writerWord(binary_writer_t *writer, const char *word, postings_t *postings) {
+    size_t len = strlen(word), shared = 0;
+    if (writer->failed || postings->count == 0) {
+        return;
+    }
+    for (size_t i = 1; i < postings->count; i++) {  // sort the postings unless they already are
+        if (postings->items[i].docID < postings->items[i - 1].docID) {
+            qsort(postings->items, postings->count, sizeof(posting_t), comparePostings);
+            break;
+        }
+    }
+    writer->block.len = 0;
+    bool ok = true;
+    for (size_t i = 0; ok && i < postings->count; i++) {
+        uint64_t delta = postings->items[i].docID - (i == 0 ? 0 : postings->items[i - 1].docID);
+        int count = postings->items[i].count;   // most counts are 1: a bit of the delta says so
+        ok = bytesVarint(&writer->block, delta << 1 | (count > 1)) && (count == 1
+                                                                || bytesVarint(&writer->block, count - 2));
+    }
+    for (; writer->last != NULL && writer->last[shared] != '\0' && writer->last[shared] == word[shared]; shared++);
+    ok = ok && bytesVarint(&writer->dict, shared) && bytesVarint(&writer->dict, len - shared)
+            && bytesAdd(&writer->dict, word + shared, len - shared) && bytesVarint(&writer->dict, postings->count)
+            && bytesVarint(&writer->dict, writer->block.len)
+            && fwrite(writer->block.data, 1, writer->block.len, writer->fp) == writer->block.len;
+    if (ok && len + 1 > writer->lastCap) {  // keep the word for the next one
+        char *grown = realloc(writer->last, 2 * (len + 1));
+        ok = grown != NULL;
+        writer->last = ok ? grown : writer->last;
+        writer->lastCap = ok ? 2 * (len + 1) : writer->lastCap;
+    }
+    if (!ok) {
+        writer->failed = true;
+        return;
+    }
+    memcpy(writer->last, word, len + 1);
+    writer->postingsCrc = crc32(writer->postingsCrc, writer->block.data, writer->block.len);
+    writer->postingsBytes += writer->block.len;
+    writer->postings += postings->count;
+    writer->words++;
+}
+
+/* function to finish a binary index file */
+static int writerClose(binary_writer_t *writer) {
+    unsigned char header[HEADER] = { 0 };
+    memcpy(header, IndexMagic, MAGIC_LEN);
+    putLE(header + 8, writer->postings, 8);
+    putLE(header + 16, writer->postingsBytes, 8);
+    putLE(header + 24, writer->dict.len, 8);
+    putLE(header + 32, writer->words, 4);
+    putLE(header + 36, writer->postingsCrc, 4);
+    putLE(header + 40, crc32(0, writer->dict.data, writer->dict.len), 4);
+    putLE(header + 44, crc32(0, header, 44), 4);
+    bool ok = !writer->failed && (writer->dict.len == 0
+                                    || fwrite(writer->dict.data, 1, writer->dict.len, writer->fp) == writer->dict.len)
+                && fseek(writer->fp, 0, SEEK_SET) == 0 && fwrite(header, 1, HEADER, writer->fp) == HEADER;
+    ok = fclose(writer->fp) == 0 && ok;
+    free(writer->block.data);
+    free(writer->dict.data);
+    free(writer->last);
+    return ok ? 0 : -1;
+}
+
+/* function to add a posting to the postings_t passed as arg, using iterate */
+static void collectPosting(void *arg, const int key, const int value) {
+    postings_t *postings = arg;
+    if (postings == NULL || key < 1 || value < 1 || postings->failed) {    // validate arguments
+        return;
+    }
+    if (postings->count == postings->capacity) {    // grow the postings
+        size_t capacity = postings->capacity == 0 ? 256 : 2 * postings->capacity;
+        posting_t *grown = realloc(postings->items, capacity * sizeof(posting_t));
+        if (grown == NULL) {
+            postings->failed = true;
+            return;
+        }
+        postings->items = grown;
+        postings->capacity = capacity;
+    }
+    postings->items[postings->count++] = (posting_t) { key, value };
+}
+
+/* function to add the postings of a line of an index file */
+static void parsePostings(const char *rest, postings_t *postings) {
+    char *end;
+    for (;;) {
+        long docID = strtol(rest, &end, 10);
+        if (end == rest) {  // no more pairs
+            return;
+        }
+        rest = end;
+        long count = strtol(rest, &end, 10);
+        if (end == rest || docID < 1 || docID > INT32_MAX || count < 1 || count > INT32_MAX) {
+            return;
+        }
+        rest = end;
+        collectPosting(postings, (int) docID, (int) count);
+    }
+}
+
+/* function to order postings by docID */
+static int comparePostings(const void *a, const void *b) {
+    int x = ((const posting_t *) a)->docID, y = ((const posting_t *) b)->docID;
+    return (x > y) - (x < y);
+}
+
+/* function to add bytes to a buffer */
+static bool bytesAdd(bytes_t *bytes, const void *data, const size_t len) {
+    if (bytes->len + len > bytes->capacity) {   // grow the buffer
+        size_t capacity = bytes->capacity == 0 ? 4096 : bytes->capacity;
+        for (; capacity < bytes->len + len; capacity *= 2);
+        unsigned char *grown = realloc(bytes->data, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        bytes->data = grown;
+        bytes->capacity = capacity;
+    }
+    if (len > 0) {
+        memcpy(bytes->data + bytes->len, data, len);
+    }
+    bytes->len += len;
+    return true;
+}
+
+/* function to add a varint to a buffer */
+static bool bytesVarint(bytes_t *bytes, uint64_t value) {
+    unsigned char buf[10];
+    int n = 0;
+    for (; value > 0x7f; value >>= 7) {
+        buf[n++] = (value & 0x7f) | 0x80;
+    }
+    buf[n++] = value;
+    return bytesAdd(bytes, buf, n);
+}
+
+/* function to read a varint */
+static bool getVarint(const unsigned char **p, const unsigned char *end, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        unsigned char byte = *(*p)++;
+        *value |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* function to write a little endian integer */
+static void putLE(unsigned char *buf, uint64_t value, const int bytes) {
+    for (int i = 0; i < bytes; i++, value >>= 8) {
+        buf[i] = value & 0xff;
+    }
+}
+
+/* function to read a little endian integer */
+static uint64_t getLE(const unsigned char *buf, const int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = value << 8 | buf[i];
+    }
+    return value;
+}
@@ -8,6 +8,7 @@
  * @copyright Copyright (c) 2022
  * 
  */
+#include <stdbool.h>
 #include "hashtable.h"
 #include "counters.h"
 
@@ -15,6 +16,16 @@
 #define IndexCoeff 825 // alter this in compilation (using D flag) to improve table efficiency of hashtable
 #endif
 
+#ifndef IndexWordBytes
+#define IndexWordBytes 96 // heap a word new to an index takes besides its letters (table entry, key copy, counters)
+#endif
+
+#ifndef IndexPostingBytes
+#define IndexPostingBytes 32 // heap a docID new to the counters of a word takes
+#endif
+
+#define IndexMagic "TSEINDX1" // first bytes of a binary index file (see indexSaveBinary)
+
 /**
  * @brief extends to hashtable struct type into an index_t type
  * 
@@ -42,6 +53,19 @@ index_t *indexInit(const int slots);
  */
 int indexAdd(index_t *index, const char *word, const int docID);
 
+/**
+ * @brief function to insert/update a word already in lower case in the index
+ * 
+ * @param index : index to update
+ * @param word  : lower case word to add to the index (not changed, and only copied if new to the index)
+ * @param docID : docID of document where word was found
+ * @param bytes : if not NULL, the heap the index grew by is added to it (IndexWordBytes and IndexPostingBytes)
+ * 
+ * @return int : 0 if success -1 if failure
+ * indexAdd without normalizing word, for callers that lower cased it as they read it (see wordscanLower)
+ */
+int indexAddLower(index_t *index, const char *word, const int docID, size_t *bytes);
+
 /**
  * @brief 
  * 
@@ -62,15 +86,35 @@ counters_t *indexFind(index_t *index, const char *word);
  */
 int indexUpdate(index_t *index, const char *word, const int docID, const int freq);
 
+/**
+ * @brief function to add the counts of another index into an index
+ * 
+ * @param index index to update
+ * @param other index whose counts are added (left as it is)
+ * @return int 0 if success ; -1 if failure
+ * used to combine indexes built over separate documents, as the indexer's workers build them; the docIDs
+ * other adds to a word follow those the word had, in the order other had them
+ */
+int indexMerge(index_t *index, index_t *other);
+
 /**
  * @brief load an index from a file
  * 
- * @param fn  : name of file to load index from
+ * @param fn  : name of file to load index from (saved by indexSave or, if it starts with IndexMagic,
+ *              by indexSaveBinary)
  * 
  * @return index_t * : loaded index 
  */
 index_t *indexLoad(const char* fn);
 
+/**
+ * @brief function to load an index from a file saved by indexSaveBinary
+ * 
+ * @param fn  : name of file to load index from
+ * @return index_t* loaded index, or NULL if the file cannot be read or fails a check (sizes or checksums)
+ */
+index_t *indexLoadBinary(const char *fn);
+
 /**
  * @brief functiom to delete an index and free used heap memory
  * 
@@ -88,3 +132,45 @@ void indexDelete(index_t *index);
  */
 void indexSave(index_t *index, const char *fn);
 
+/**
+ * @brief function to save an index to a file as indexSave does, with the words in strcmp order
+ * 
+ * @param index : index to save to file
+ * @param fn    : name of file to save index to
+ * @return int 0 if success ; -1 if failure (the file may be left part written)
+ * used for the runs an index built in pieces is written as, to be merged by indexMergeRuns
+ */
+int indexSaveSorted(index_t *index, const char *fn);
+
+/**
+ * @brief function to save an index to a file in binary: a header, the postings, then a sorted dictionary
+ * 
+ * @param index : index to save to file
+ * @param fn    : name of file to save index to
+ * @return int 0 if success ; -1 if failure (the file may be left part written)
+ * do
+ *  - write a 48 byte header: IndexMagic, the number of postings, the size of the postings and of the
+ *    dictionary (8 bytes each), the number of words, a crc32 of the postings, of the dictionary and of the
+ *    header before it (4 bytes each), all little endian
+ *  - write the postings of each word in dictionary order, sorted by docID: the docID less the one before it
+ *    (0 for the first) times 2, plus 1 if the count is over 1, as a varint, then count - 2 as a varint if so
+ *  - write the dictionary: each word in strcmp order as the bytes it shares with the word before it and the
+ *    rest (varint, varint, bytes), then its number of postings and their size (varints)
+ */
+int indexSaveBinary(index_t *index, const char *fn);
+
+/**
+ * @brief function to merge index files saved by indexSaveSorted into one index file, reading each once
+ * 
+ * @param runs  : names of the files to merge
+ * @param count : number of runs
+ * @param fn    : name of file to save the merged index to
+ * @param binary : save as indexSaveBinary would, rather than as indexSave would
+ * @return int 0 if success ; -1 if failure (the file may be left part written)
+ * do
+ *  - write each word once, in strcmp order, with the docIDs and counts of every run it is in
+ *  - a word's docIDs follow the order of runs, then the order they are in within a run
+ *  - hold one line of each run in memory at a time
+ */
+int indexMergeRuns(const char *runs[], const int count, const char *fn, const bool binary);
+
@@ -0,0 +1,589 @@
+/**
+ * @file inflate.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in inflate.h (a self contained decoder for deflate, zlib and gzip data)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "inflate.h"
+#include "crc.h"
+
+enum { MAX_BITS = 15 };         // longest code deflate allows
+enum { MAX_LCODES = 288 };      // literal/length symbols
+enum { MAX_DCODES = 30 };       // distance symbols
+enum { FAST_BITS = 9 };         // codes this long or shorter are decoded with one table lookup
+static const size_t OUT_START = 16384;  // first size of the output buffer
+
+/**
+ * @brief canonical huffman code: symbols sorted by code length, and a lookup table for the short codes
+ *
+ */
+typedef struct huffman {
+    short count[MAX_BITS + 1];          // number of codes of each length
+    short symbol[MAX_LCODES];           // symbols in code order
+    unsigned short fast[1 << FAST_BITS];   // next FAST_BITS input bits -> symbol << 4 | code length, 0 if longer
+} huffman_t;
+
+/**
+ * @brief decoder state: the input, the bits not yet used and the output so far
+ *
+ */
+typedef struct inflateState {
+    const unsigned char *in;    // compressed bytes
+    size_t inLen;               // number of compressed bytes
+    size_t inPos;               // next unread byte
+    uint64_t bitBuf;            // input bits not yet used, first bit lowest
+    int bitCount;               // number of bits in bitBuf
+    unsigned char *out;         // decoded data (malloc'd)
+    size_t outLen;              // bytes decoded
+    size_t outCap;              // size of out, less the byte kept for the '\0'
+} inflate_state_t;
+
+/**
+ * @brief function to read the next input byte
+ *
+ * @param s decoder state
+ * @return int the byte, or -1 at the end of the input
+ */
+static int nextByte(inflate_state_t *s);
+
+/**
+ * @brief function to take n bits from the input, first bit lowest
+ *
+ * @param s decoder state
+ * @param n number of bits (at most 32)
+ * @return long the bits, or -1 if the input ends first
+ */
+static long getBits(inflate_state_t *s, const int n);
+
+/**
+ * @brief function to make room for n more bytes of output
+ *
+ * @param s decoder state
+ * @param n number of bytes
+ * @return true if there is room
+ * @return false if out of memory or the output would pass InflateLimit
+ */
+static bool reserve(inflate_state_t *s, const size_t n);
+
+/**
+ * @brief function to build a canonical huffman code from the code length of each symbol
+ *
+ * @param h code to build
+ * @param length code length of each symbol (0 if the symbol is not used)
+ * @param n number of symbols
+ * @return true if the lengths describe a valid (possibly incomplete) code
+ * @return false if they are over-subscribed
+ */
+static bool construct(huffman_t *h, const short *length, const int n);
+
+/**
+ * @brief function to decode one symbol
+ *
+ * @param s decoder state
+ * @param h code to decode with
+ * @return int the symbol, or -1 if the input ends or holds a code that is not in h
+ */
+static int decode(inflate_state_t *s, const huffman_t *h);
+
+/**
+ * @brief function to decode the compressed data of a block until its end-of-block symbol
+ *
+ * @param s decoder state
+ * @param lencode literal/length code of the block
+ * @param distcode distance code of the block
+ * @return true if the block was decoded
+ */
+static bool codes(inflate_state_t *s, const huffman_t *lencode, const huffman_t *distcode);
+
+/**
+ * @brief function to copy a stored (uncompressed) block to the output
+ *
+ * @param s decoder state
+ * @return true if the block was copied
+ */
+static bool stored(inflate_state_t *s);
+
+/**
+ * @brief function to decode a block compressed with the fixed codes
+ *
+ * @param s decoder state
+ * @return true if the block was decoded
+ */
+static bool fixed(inflate_state_t *s);
+
+/**
+ * @brief function to read the codes of a block compressed with dynamic codes, then decode the block
+ *
+ * @param s decoder state
+ * @return true if the block was decoded
+ */
+static bool dynamic(inflate_state_t *s);
+
+/**
+ * @brief function to decode deflate blocks up to and including the last one
+ *
+ * @param s decoder state
+ * @return true if every block was decoded
+ */
+static bool inflateBlocks(inflate_state_t *s);
+
+/**
+ * @brief function to read the gzip header, which may carry extra data, a file name, a comment and a header crc
+ *
+ * @param s decoder state
+ * @return true if the header is valid
+ */
+static bool gzipHeader(inflate_state_t *s);
+
+/**
+ * @brief function to read a little endian 32 bit trailer field
+ *
+ * @param s decoder state
+ * @param value pointer to store the field
+ * @return true if the field was read
+ */
+static bool getWord(inflate_state_t *s, uint32_t *value);
+
+/**
+ * @brief function to compute the Adler-32 (as zlib uses it) of data
+ *
+ * @param data bytes to check
+ * @param len number of bytes
+ * @return uint32_t checksum
+ */
+static uint32_t adler32(const unsigned char *data, const size_t len);
+
+// base length and extra bits of length symbols 257..285, and base distance and extra bits of distance symbols 0..29
+static const short LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const short LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const unsigned short DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577 };
+static const short DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/* see inflate.h for more information */
+char *inflateBuffer(const inflate_format_t format, const void *data, const size_t size, size_t *len) {
+    // validate arguments
+    if (data == NULL) {
+        return NULL;
+    }
+    inflate_state_t s;
+    memset(&s, 0, sizeof(s));
+    s.in = data;
+    s.inLen = size;
+    if (!reserve(&s, 1)) {
+        return NULL;
+    }
+    inflate_format_t wrapper = format;
+    if (format == INFLATE_DEFLATE) {    // zlib if the first two bytes are a zlib header, raw otherwise
+        long cmf = getBits(&s, 8), flg = getBits(&s, 8);
+        wrapper = (cmf >= 0 && flg >= 0 && (cmf & 0x0f) == 8 && (cmf * 256 + flg) % 31 == 0) ? INFLATE_ZLIB : INFLATE_RAW;
+        if (cmf >= 0 && flg >= 0) {    // put them back
+            s.bitBuf = (uint64_t) cmf | (uint64_t) flg << 8;
+            s.bitCount = 16;
+        }
+    }
+    bool ok = true;
+    if (wrapper == INFLATE_ZLIB) {
+        long cmf = getBits(&s, 8), flg = getBits(&s, 8);
+        ok = cmf >= 0 && flg >= 0 && (cmf & 0x0f) == 8 && (cmf >> 4) <= 7 && (cmf * 256 + flg) % 31 == 0
+             && (flg & 0x20) == 0;    // no preset dictionary
+    } else if (wrapper == INFLATE_GZIP) {
+        ok = gzipHeader(&s);
+    }
+    ok = ok && inflateBlocks(&s);
+    if (ok && wrapper != INFLATE_RAW) {
+        s.bitBuf >>= s.bitCount & 7;    // the trailer starts on a byte boundary
+        s.bitCount -= s.bitCount & 7;
+    }
+    if (ok && wrapper == INFLATE_ZLIB) {
+        uint32_t check = 0;
+        for (int i = 0; ok && i < 4; i++) {     // big endian
+            long byte = getBits(&s, 8);
+            ok = byte >= 0;
+            check = check << 8 | (uint32_t) byte;
+        }
+        ok = ok && check == adler32(s.out, s.outLen);
+    } else if (ok && wrapper == INFLATE_GZIP) {
+        uint32_t check, size;
+        ok = getWord(&s, &check) && getWord(&s, &size) && check == crc32(0, s.out, s.outLen)
+             && size == (uint32_t) s.outLen;
+    }
+    if (!ok) {
+        free(s.out);
+        return NULL;
+    }
+    s.out[s.outLen] = '\0';
+    if (len != NULL) {
+        *len = s.outLen;
+    }
+    return (char *) s.out;
+}
+
+/* function to read the next input byte */
+static int nextByte(inflate_state_t *s) {
+    return s->inPos < s->inLen ? s->in[s->inPos++] : -1;
+}
+
+/* function to take n bits from the input */
+static long getBits(inflate_state_t *s, const int n) {
+    while (s->bitCount < n) {
+        int byte = nextByte(s);
+        if (byte < 0) {
+            return -1;
+        }
+        s->bitBuf |= (uint64_t) byte << s->bitCount;
+        s->bitCount += 8;
+    }
+    long value = (long) (s->bitBuf & ((1ULL << n) - 1));
+    s->bitBuf >>= n;
+    s->bitCount -= n;
+    return value;
+}
+
+/* function to make room for n more bytes of output */
+static bool reserve(inflate_state_t *s, const size_t n) {
+    if (s->outCap - s->outLen >= n) {
+        return true;
+    }
+    if (s->outLen + n > (size_t) InflateLimit) {
+        return false;
+    }
+    size_t cap = s->outCap == 0 ? OUT_START : s->outCap;
+    while (cap - s->outLen < n) {
+        cap *= 2;
+    }
+    if (cap > (size_t) InflateLimit) {
+        cap = InflateLimit;
+    }
+    unsigned char *out = realloc(s->out, cap + 1);  // + 1 for the '\0'
+    if (out == NULL) {
+        return false;
+    }
+    s->out = out;
+    s->outCap = cap;
+    return true;
+}
+
+/* function to build a canonical huffman code from the code length of each symbol */
+static bool construct(huffman_t *h, const short *length, const int n) {
+    memset(h->count, 0, sizeof(h->count));
+    for (int i = 0; i < n; i++) {
+        h->count[length[i]]++;
+    }
+    if (h->count[0] == n) {     // no codes: any use of them fails in decode
+        memset(h->fast, 0, sizeof(h->fast));
+        return true;
+    }
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; len++) {     // over-subscribed lengths cannot be decoded
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+    short offs[MAX_BITS + 1];
+    offs[1] = 0;
+    for (int len = 1; len < MAX_BITS; len++) {
+        offs[len + 1] = offs[len] + h->count[len];
+    }
+    for (int i = 0; i < n; i++) {   // symbols in code order: by length, then by symbol
+        if (length[i] != 0) {
+            h->symbol[offs[length[i]]++] = i;
+        }
+    }
+    // fill the lookup table: a code of len bits covers every entry whose low len bits are the code, reversed
+    memset(h->fast, 0, sizeof(h->fast));
+    int code = 0, index = 0;
+    for (int len = 1; len <= FAST_BITS; len++) {
+        for (int i = 0; i < h->count[len]; i++, code++, index++) {
+            int reversed = 0;
+            for (int b = 0; b < len; b++) {
+                reversed |= ((code >> b) & 1) << (len - 1 - b);
+            }
+            for (int entry = reversed; entry < (1 << FAST_BITS); entry += 1 << len) {
+                h->fast[entry] = (unsigned short) (h->symbol[index] << 4 | len);
+            }
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+/* function to decode one symbol */
+static int decode(inflate_state_t *s, const huffman_t *h) {
+    while (s->bitCount < FAST_BITS) {   // fill what the input still has
+        int byte = nextByte(s);
+        if (byte < 0) {
+            break;
+        }
+        s->bitBuf |= (uint64_t) byte << s->bitCount;
+        s->bitCount += 8;
+    }
+    if (s->bitCount >= FAST_BITS) {
+        unsigned short entry = h->fast[s->bitBuf & ((1 << FAST_BITS) - 1)];
+        if (entry != 0) {
+            s->bitBuf >>= entry & 15;
+            s->bitCount -= entry & 15;
+            return entry >> 4;
+        }
+    }
+    // a long code, or the last few bits of the input: walk the code one bit at a time
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= MAX_BITS; len++) {
+        long bit = getBits(s, 1);
+        if (bit < 0) {
+            return -1;
+        }
+        code |= bit;
+        int count = h->count[len];
+        if (code - count < first) {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+/* function to decode the compressed data of a block until its end-of-block symbol */
+static bool codes(inflate_state_t *s, const huffman_t *lencode, const huffman_t *distcode) {
+    for (;;) {
+        int symbol = decode(s, lencode);
+        if (symbol < 0) {
+            return false;
+        } else if (symbol < 256) {  // literal
+            if (!reserve(s, 1)) {
+                return false;
+            }
+            s->out[s->outLen++] = (unsigned char) symbol;
+        } else if (symbol == 256) {     // end of block
+            return true;
+        } else {    // length and distance back into the output
+            symbol -= 257;
+            if (symbol >= 29) {
+                return false;
+            }
+            long extra = getBits(s, LEN_EXTRA[symbol]);
+            int dsym = decode(s, distcode);
+            if (extra < 0 || dsym < 0 || dsym >= 30) {
+                return false;
+            }
+            size_t len = LEN_BASE[symbol] + extra;
+            long dextra = getBits(s, DIST_EXTRA[dsym]);
+            if (dextra < 0) {
+                return false;
+            }
+            size_t dist = DIST_BASE[dsym] + dextra;
+            if (dist > s->outLen || !reserve(s, len)) {
+                return false;
+            }
+            unsigned char *to = s->out + s->outLen, *from = to - dist;
+            for (size_t i = 0; i < len; i++) {  // byte by byte: the copy may overlap itself
+                to[i] = from[i];
+            }
+            s->outLen += len;
+        }
+    }
+}
+
+/* function to copy a stored (uncompressed) block to the output */
+static bool stored(inflate_state_t *s) {
+    s->bitBuf >>= s->bitCount & 7;  // the block starts on a byte boundary
+    s->bitCount -= s->bitCount & 7;
+    long len = getBits(s, 16), nlen = getBits(s, 16);
+    if (len < 0 || nlen < 0 || len != (~nlen & 0xffff) || !reserve(s, len)) {
+        return false;
+    }
+    while (len > 0 && s->bitCount >= 8) {   // bytes already in the bit buffer
+        s->out[s->outLen++] = (unsigned char) getBits(s, 8);
+        len--;
+    }
+    if ((size_t) len > s->inLen - s->inPos) {   // then straight from the input
+        return false;
+    }
+    memcpy(s->out + s->outLen, s->in + s->inPos, len);
+    s->inPos += len;
+    s->outLen += len;
+    return true;
+}
+
+/* function to decode a block compressed with the fixed codes */
+static bool fixed(inflate_state_t *s) {
+    huffman_t lencode, distcode;
+    short lengths[MAX_LCODES];
+    int symbol = 0;
+    for (; symbol < 144; symbol++) lengths[symbol] = 8;
+    for (; symbol < 256; symbol++) lengths[symbol] = 9;
+    for (; symbol < 280; symbol++) lengths[symbol] = 7;
+    for (; symbol < MAX_LCODES; symbol++) lengths[symbol] = 8;
+    construct(&lencode, lengths, MAX_LCODES);
+    for (symbol = 0; symbol < MAX_DCODES; symbol++) lengths[symbol] = 5;
+    construct(&distcode, lengths, MAX_DCODES);
+    return codes(s, &lencode, &distcode);
+}
+
+/* function to read the codes of a block compressed with dynamic codes, then decode the block */
+static bool dynamic(inflate_state_t *s) {
+    static const short ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    long nlen = getBits(s, 5), ndist = getBits(s, 5), ncode = getBits(s, 4);
+    if (nlen < 0 || ndist < 0 || ncode < 0) {
+        return false;
+    }
+    nlen += 257;
+    ndist += 1;
+    ncode += 4;
+    if (nlen > 286 || ndist > MAX_DCODES) {
+        return false;
+    }
+    huffman_t lencode, distcode;
+    short lengths[MAX_LCODES + MAX_DCODES];
+    memset(lengths, 0, sizeof(lengths));
+    for (int i = 0; i < ncode; i++) {   // code length code lengths, 3 bits each in a fixed order
+        long len = getBits(s, 3);
+        if (len < 0) {
+            return false;
+        }
+        lengths[ORDER[i]] = (short) len;
+    }
+    if (!construct(&lencode, lengths, 19)) {
+        return false;
+    }
+    for (int index = 0; index < nlen + ndist; ) {   // literal/length then distance code lengths, run length coded
+        int symbol = decode(s, &lencode);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = (short) symbol;
+            continue;
+        }
+        short len = 0;
+        long repeat;
+        if (symbol == 16) {     // repeat the last length 3..6 times
+            if (index == 0) {
+                return false;
+            }
+            len = lengths[index - 1];
+            repeat = getBits(s, 2);
+            repeat = repeat < 0 ? -1 : 3 + repeat;
+        } else if (symbol == 17) {  // 3..10 zeros
+            repeat = getBits(s, 3);
+            repeat = repeat < 0 ? -1 : 3 + repeat;
+        } else {    // 11..138 zeros
+            repeat = getBits(s, 7);
+            repeat = repeat < 0 ? -1 : 11 + repeat;
+        }
+        if (repeat < 0 || index + repeat > nlen + ndist) {
+            return false;
+        }
+        while (repeat-- > 0) {
+            lengths[index++] = len;
+        }
+    }
+    if (lengths[256] == 0) {    // no end-of-block code
+        return false;
+    }
+    if (!construct(&lencode, lengths, nlen) || !construct(&distcode, lengths + nlen, ndist)) {
+        return false;
+    }
+    return codes(s, &lencode, &distcode);
+}
+
+/* function to decode deflate blocks up to and including the last one */
+static bool inflateBlocks(inflate_state_t *s) {
+    long last;
+    do {
+        last = getBits(s, 1);
+        long type = getBits(s, 2);
+        bool ok = false;
+        if (last >= 0 && type == 0) {
+            ok = stored(s);
+        } else if (last >= 0 && type == 1) {
+            ok = fixed(s);
+        } else if (last >= 0 && type == 2) {
+            ok = dynamic(s);
+        }
+        if (!ok) {
+            return false;
+        }
+    } while (last == 0);
+    return true;
+}
+
+/* function to read the gzip header */
+static bool gzipHeader(inflate_state_t *s) {
+    long id1 = getBits(s, 8), id2 = getBits(s, 8), method = getBits(s, 8), flags = getBits(s, 8);
+    if (id1 != 0x1f || id2 != 0x8b || method != 8 || flags < 0 || (flags & 0xe0) != 0) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {   // modification time, extra flags and operating system
+        if (getBits(s, 8) < 0) {
+            return false;
+        }
+    }
+    if (flags & 0x04) {     // FEXTRA: length then data
+        long xlen = getBits(s, 16);
+        if (xlen < 0) {
+            return false;
+        }
+        while (xlen-- > 0) {
+            if (getBits(s, 8) < 0) {
+                return false;
+            }
+        }
+    }
+    for (int field = 0x08; field <= 0x10; field <<= 1) {   // FNAME then FCOMMENT: '\0' terminated
+        if (flags & field) {
+            long byte;
+            while ((byte = getBits(s, 8)) > 0);
+            if (byte < 0) {
+                return false;
+            }
+        }
+    }
+    if ((flags & 0x02) && getBits(s, 16) < 0) {     // FHCRC
+        return false;
+    }
+    return true;
+}
+
+/* function to read a little endian 32 bit trailer field */
+static bool getWord(inflate_state_t *s, uint32_t *value) {
+    long low = getBits(s, 16), high = getBits(s, 16);
+    if (low < 0 || high < 0) {
+        return false;
+    }
+    *value = (uint32_t) high << 16 | (uint32_t) low;
+    return true;
+}
+
+/* function to compute the Adler-32 (as zlib uses it) of data */
+static uint32_t adler32(const unsigned char *data, const size_t len) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < len; ) {
+        size_t end = i + 5552 < len ? i + 5552 : len;   // largest run before b can overflow
+        for (; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file inflate.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief inflate provides a self contained decoder for deflate data (RFC 1951) and its zlib and gzip wrappers
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __INFLATE_H_
+#define __INFLATE_H_
+#include <stddef.h>
+
+#ifndef InflateLimit
+#define InflateLimit (64L << 20) // largest decoded body accepted, so a small response cannot expand without bound
+#endif
+
+/**
+ * @brief wrapper around the deflate data
+ *
+ */
+typedef enum inflateFormat {
+    INFLATE_RAW,        // bare deflate blocks
+    INFLATE_ZLIB,       // zlib header and Adler-32 trailer (RFC 1950)
+    INFLATE_GZIP,       // gzip header and CRC-32 trailer (RFC 1952)
+    INFLATE_DEFLATE     // what servers send as Content-Encoding: deflate: zlib if it has a zlib header, otherwise raw
+} inflate_format_t;
+
+/**
+ * @brief function to decode compressed data held in memory
+ *
+ * @param format wrapper around the deflate data
+ * @param data compressed bytes
+ * @param size number of compressed bytes
+ * @param len pointer to store the length of the decoded data (may be NULL)
+ * @return char* decoded data (malloc'd, with a '\0' after it) or NULL if it is corrupt, truncated or too large
+ * do
+ *  - check the header and trailer of the wrapper, including its checksum and length
+ *  - decode straight into the returned buffer, which is grown as the output needs and never past InflateLimit
+ */
+char *inflateBuffer(const inflate_format_t format, const void *data, const size_t size, size_t *len);
+
+#endif
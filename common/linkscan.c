@@ -0,0 +1,260 @@
+/**
+ * @file linkscan.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in linkscan.h (link extraction and url normalization without copies of the html)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L     // strncasecmp
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include "linkscan.h"
+
+static const char SCHEME[] = "http://";    // the only scheme the crawler follows
+
+/**
+ * @brief function to find the value of the href attribute of a tag
+ *
+ * @param c start of the tag's attributes
+ * @param tagEnd '>' closing the tag, or NULL if the html ends first
+ * @return const char* first byte after "href=" and any whitespace, or NULL if the tag has no href
+ */
+static const char *hrefValue(const char *c, const char *tagEnd);
+
+/**
+ * @brief function to copy bytes to buf, leaving out whitespace
+ *
+ * @return size_t bytes copied
+ */
+static size_t copyCompact(char *buf, const char *from, const size_t len);
+
+/**
+ * @brief function to remove "." and ".." segments from a path in place (RFC 3986 section 5.2.4), as libcs50 does
+ *
+ * @param path path (starting with '/')
+ * @param end end of the path
+ * @return char* end of the path once the segments are removed
+ */
+static char *removeDots(char *path, char *end);
+
+/**
+ * @brief function to remove the last segment, and the '/' before it, from the output of removeDots
+ *
+ */
+static char *dropSegment(char *start, char *out);
+
+/* see linkscan.h for more information */
+bool linkscanNext(const char *html, size_t *pos, link_span_t *link) {
+    // validate arguments
+    if (html == NULL || pos == NULL || link == NULL) {
+        return false;
+    }
+    const char *c = html + *pos;
+    while ((c = strchr(c, '<')) != NULL) {
+        c++;
+        if (*c != 'a' && *c != 'A') {
+            continue;
+        }
+        const char *value = hrefValue(c + 1, strchr(c, '>'));
+        if (value == NULL) {
+            continue;
+        }
+        const char *end;
+        if (*value == '"' || *value == '\'') {  // quoted: up to the same quote
+            end = strchr(value + 1, *value);
+            value++;
+        } else {    // unquoted: up to whitespace or the end of the tag
+            for (end = value; *end != '\0' && *end != '>' && !isspace((unsigned char) *end); end++) {
+            }
+            end = *end == '\0' ? NULL : end;
+        }
+        if (end == NULL) {  // the html ends inside the value
+            continue;
+        }
+        const char *hash = memchr(value, '#', end - value);
+        end = hash != NULL ? hash : end;
+        c = end;
+        while (value < end && isspace((unsigned char) *value)) {
+            value++;
+        }
+        if (value == hash) {    // a fragment of this page
+            continue;
+        }
+        const char *mark = value;   // an absolute url has a ':' before any '/' or '?'
+        while (mark < end && *mark != ':' && *mark != '/' && *mark != '?') {
+            mark++;
+        }
+        if (mark < end && *mark == ':' && strncasecmp(value, "http", 4) != 0) {    // mailto:, ftp:, javascript:
+            continue;
+        }
+        link->start = value - html;
+        link->len = end - value;
+        *pos = end - html;
+        return true;
+    }
+    *pos += strlen(html + *pos);
+    return false;
+}
+
+/* see linkscan.h for more information */
+size_t linkscanSize(const char *base, const link_span_t *link) {
+    return (base == NULL ? 0 : strlen(base)) + (link == NULL ? 0 : link->len) + 2;
+}
+
+/* see linkscan.h for more information */
+size_t linkscanResolve(const char *base, const char *html, const link_span_t *link, char *buf, const size_t size) {
+    // validate arguments
+    if (base == NULL || html == NULL || link == NULL || buf == NULL || size < linkscanSize(base, link)) {
+        return 0;
+    }
+    const char *value = html + link->start;
+    const char *end = value + link->len;
+    const char *mark = value;
+    while (mark < end && *mark != ':' && *mark != '/' && *mark != '?') {
+        mark++;
+    }
+    size_t n = 0;
+    if (mark < end && *mark == ':') {   // absolute
+        n = copyCompact(buf, value, link->len);
+    } else {    // relative to the host of base, or to its directory
+        const char *authority = strstr(base, "//");
+        const char *hostEnd = authority == NULL ? NULL : strchr(authority + 2, '/');
+        if (hostEnd == NULL) {
+            return 0;
+        }
+        memcpy(buf, base, hostEnd - base);
+        n = hostEnd - base;
+        while (value < end && isspace((unsigned char) *value)) {
+            value++;
+        }
+        if (value == end || *value != '/') {
+            const char *pathEnd = hostEnd + strcspn(hostEnd, "?#");
+            const char *slash = pathEnd;
+            while (slash > hostEnd && *slash != '/') {
+                slash--;
+            }
+            if (slash != hostEnd) {
+                memcpy(buf + n, hostEnd, slash - hostEnd);
+                n += slash - hostEnd;
+            }
+            buf[n++] = '/';
+        }
+        n += copyCompact(buf + n, value, end - value);
+    }
+    buf[n] = '\0';
+
+    // normalize in place
+    if (strncasecmp(buf, SCHEME, sizeof(SCHEME) - 1) != 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(SCHEME) - 1; i++) {
+        buf[i] = tolower((unsigned char) buf[i]);
+    }
+    char *authority = buf + sizeof(SCHEME) - 1;
+    char *path = strchr(authority, '/');
+    if (path == NULL || strcspn(authority, "?#") < (size_t) (path - authority)) {   // no path: libcs50 fails it too
+        return 0;
+    }
+    char *host = memchr(authority, '@', path - authority);
+    for (host = host == NULL ? authority : host + 1; host < path; host++) {
+        *host = tolower((unsigned char) *host);
+    }
+    char *query = path + strcspn(path, "?");
+    char *dot = NULL;
+    for (char *p = query - 1; p > path && *p != '/'; p--) {     // the extension is after the last '/'
+        if (*p == '.') {
+            dot = p;
+            break;
+        }
+    }
+    if (dot != NULL && dot + 1 < query && (query - dot - 1 < 3 || strncasecmp(dot + 1, "htm", 3) != 0)) {
+        return 0;   // html and htm (and extensions starting with them) only, as normalizeURL
+    }
+    char *pathEnd = removeDots(path, query);
+    size_t rest = strlen(query);
+    memmove(pathEnd, query, rest + 1);
+    return pathEnd + rest - buf;
+}
+
+/* function to find the value of the href attribute of a tag */
+static const char *hrefValue(const char *c, const char *tagEnd) {
+    for (; *c != '\0' && (tagEnd == NULL || c < tagEnd); c++) {
+        if (strncasecmp(c, "href", 4) != 0) {
+            continue;
+        }
+        const char *eq = c + 4;
+        while (isspace((unsigned char) *eq)) {
+            eq++;
+        }
+        if (*eq == '=' && (tagEnd == NULL || eq < tagEnd)) {
+            eq++;
+            while (isspace((unsigned char) *eq)) {
+                eq++;
+            }
+            return eq;
+        }
+    }
+    return NULL;
+}
+
+/* function to copy bytes to buf, leaving out whitespace */
+static size_t copyCompact(char *buf, const char *from, const size_t len) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!isspace((unsigned char) from[i])) {
+            buf[n++] = from[i];
+        }
+    }
+    return n;
+}
+
+/* function to remove "." and ".." segments from a path in place */
+static char *removeDots(char *path, char *end) {
+    char *in = path, *out = path;   // out never passes in, so the path can be rewritten where it is
+    while (in < end) {
+        size_t left = end - in;
+        if (left >= 2 && strncmp(in, "./", 2) == 0) {
+            in += 2;
+        } else if (left >= 3 && strncmp(in, "../", 3) == 0) {
+            in += 3;
+        } else if (left >= 3 && strncmp(in, "/./", 3) == 0) {
+            in += 2;
+        } else if (left == 2 && strncmp(in, "/.", 2) == 0) {
+            in[1] = '/';
+            in++;
+        } else if (left >= 4 && strncmp(in, "/../", 4) == 0) {
+            in += 3;
+            out = dropSegment(path, out);
+        } else if (left == 3 && strncmp(in, "/..", 3) == 0) {
+            in[2] = '/';
+            in += 2;
+            out = dropSegment(path, out);
+        } else if ((left == 1 && *in == '.') || (left == 2 && strncmp(in, "..", 2) == 0)) {
+            in = end;
+        } else {    // move the first segment to the output
+            do {
+                *out++ = *in++;
+            } while (in < end && *in != '/');
+        }
+    }
+    return out;
+}
+
+/* function to remove the last segment, and the '/' before it, from the output of removeDots */
+static char *dropSegment(char *start, char *out) {
+    while (out > start) {
+        out--;
+        if (*out == '/') {
+            break;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file linkscan.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief linkscan provides link extraction over a page's html in place: links come back as spans into the html,
+ *        and are only resolved and normalized into a buffer when asked
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __LINK_SCAN_H_
+#define __LINK_SCAN_H_
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef LinkMax
+#define LinkMax 2048 // size of the buffer a caller keeps for resolving a link; longer links need their own
+#endif
+
+/**
+ * @brief a link found in a page: the value of an href attribute, without its fragment
+ *
+ */
+typedef struct linkSpan {
+    size_t start;   // offset of the value in the html
+    size_t len;     // length of the value (may be 0: href="" links to the page's directory)
+} link_span_t;
+
+/**
+ * @brief function to find the next link in html, reading it once and changing nothing
+ *
+ * @param html html of the page
+ * @param pos offset to scan from (0 on the first call); moved past the link found
+ * @param link pointer to store the span of the link
+ * @return true if a link was found
+ * @return false once there are no more links (or any argument is NULL)
+ * do
+ *  - find the href of the next "<a" tag (so "<area" too) before the tag ends, the same links webpage_getNextURL finds
+ *  - a quoted value ends at its quote, an unquoted one at whitespace or '>'; a '#' ends the value
+ *  - skip links to a fragment of the page itself, and absolute links whose scheme is not http
+ */
+bool linkscanNext(const char *html, size_t *pos, link_span_t *link);
+
+/**
+ * @brief function to get the normalized absolute url of a link: normalizeURL of what webpage_getNextURL gives
+ *
+ * @param base normalized url of the page the link is in
+ * @param html html of the page
+ * @param link span from linkscanNext
+ * @param buf buffer to write the url to; it needs linkscanSize(base, link) bytes
+ * @param size size of buf
+ * @return size_t length of the url written (with a '\0' after it), or 0 if the link is not an http url that
+ *         normalizeURL accepts (e.g. a file that is not html) or buf is too small
+ * do
+ *  - drop whitespace in the value, as the html would have had it removed
+ *  - resolve a relative link against the directory of base
+ *  - lower case the scheme and host, check the file extension and remove "." and ".." segments, in place in buf
+ */
+size_t linkscanResolve(const char *base, const char *html, const link_span_t *link, char *buf, const size_t size);
+
+/**
+ * @brief function to get the size of buffer linkscanResolve needs for a link
+ *
+ */
+size_t linkscanSize(const char *base, const link_span_t *link);
+
+#endif
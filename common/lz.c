@@ -0,0 +1,258 @@
+/**
+ * @file lz.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in lz.h (an LZ77 block codec in the style of LZ4, and its frame)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "lz.h"
+
+enum { MIN_MATCH = 4 };         // shortest match encoded
+enum { WINDOW = 65535 };        // farthest a match may point back (2 byte offsets)
+enum { HASH_BITS = 14 };        // positions remembered: one per hash of 4 bytes
+enum { TAIL = 8 };              // no match starts in the last bytes, so the search can read 4 bytes ahead
+
+/*
+ * A block is a list of sequences. Each starts with a token: the high 4 bits give the number of literals and
+ * the low 4 bits the match length less MIN_MATCH, either being 15 when more follows in bytes of 255 ended by
+ * a byte under 255. Then come the literals, a 2 byte little endian offset and the extra match length bytes.
+ * The last sequence has literals only.
+ */
+
+/**
+ * @brief function to read 4 bytes as an integer, whatever their alignment
+ *
+ */
+static uint32_t read32(const unsigned char *p);
+
+/**
+ * @brief function to write a length over 15 as bytes of 255 ended by a smaller byte
+ *
+ */
+static unsigned char *putLength(unsigned char *out, size_t len);
+
+/**
+ * @brief function to read a length written by putLength, adding it to len
+ *
+ * @return const unsigned char* next byte, or NULL if the input ended first
+ */
+static const unsigned char *getLength(const unsigned char *in, const unsigned char *end, size_t *len);
+
+/**
+ * @brief function to compress a block
+ *
+ * @return size_t length of the block written to out, which has room for the worst case
+ */
+static size_t blockEncode(const unsigned char *src, const size_t len, unsigned char *out);
+
+/**
+ * @brief function to decode a block into exactly size bytes
+ *
+ * @return bool true if the block decoded to exactly size bytes
+ */
+static bool blockDecode(const unsigned char *in, const size_t len, unsigned char *out, const size_t size);
+
+/* see lz.h for more information */
+char *lzEncode(const char *data, const size_t len, size_t *frameLen) {
+    // validate arguments
+    if (data == NULL || frameLen == NULL || len > (size_t) LzLimit) {
+        return NULL;
+    }
+    // worst case: every byte a literal, one length byte per 255 of them, a token, the magic and the size
+    unsigned char *frame = malloc(LzMagicLen + 10 + len + len / 255 + 16);
+    if (frame == NULL) {
+        return NULL;
+    }
+    memcpy(frame, LzMagic, LzMagicLen);
+    unsigned char *out = frame + LzMagicLen;
+    for (size_t n = len; ; n >>= 7) {   // decoded size as a varint
+        *out++ = (n & 0x7f) | (n > 0x7f ? 0x80 : 0);
+        if (n <= 0x7f) {
+            break;
+        }
+    }
+    out += blockEncode((const unsigned char *) data, len, out);
+    *frameLen = out - frame;
+    unsigned char *shrunk = realloc(frame, *frameLen);  // give back the room left over
+    return shrunk == NULL ? (char *) frame : (char *) shrunk;
+}
+
+/* see lz.h for more information */
+bool lzIsFrame(const char *data, const size_t len) {
+    return data != NULL && len >= LzMagicLen && memcmp(data, LzMagic, LzMagicLen) == 0;
+}
+
+/* see lz.h for more information */
+long lzFrameSize(const char *frame, const size_t len) {
+    if (!lzIsFrame(frame, len)) {
+        return -1;
+    }
+    const unsigned char *in = (const unsigned char *) frame + LzMagicLen, *end = (const unsigned char *) frame + len;
+    long size = 0;
+    for (int shift = 0; in < end && shift < 35; shift += 7) {
+        size |= (long) (*in & 0x7f) << shift;
+        if ((*in++ & 0x80) == 0) {
+            return size <= LzLimit ? size : -1;
+        }
+    }
+    return -1;
+}
+
+/* see lz.h for more information */
+long lzDecodeInto(const char *frame, const size_t len, char *out) {
+    long size = lzFrameSize(frame, len);
+    if (size < 0 || out == NULL) {
+        return -1;
+    }
+    const unsigned char *in = (const unsigned char *) frame + LzMagicLen;
+    while (*in++ & 0x80);   // past the size
+    size_t header = in - (const unsigned char *) frame;
+    if (!blockDecode(in, len - header, (unsigned char *) out, size)) {
+        return -1;
+    }
+    out[size] = '\0';
+    return size;
+}
+
+/* see lz.h for more information */
+char *lzDecode(const char *frame, const size_t len, size_t *outLen) {
+    long size = lzFrameSize(frame, len);
+    char *out = size < 0 ? NULL : malloc(size + 1);
+    if (out == NULL || lzDecodeInto(frame, len, out) < 0) {
+        free(out);
+        return NULL;
+    }
+    if (outLen != NULL) {
+        *outLen = size;
+    }
+    return out;
+}
+
+/* function to read 4 bytes as an integer */
+static uint32_t read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/* function to write a length over 15 */
+static unsigned char *putLength(unsigned char *out, size_t len) {
+    for (; len >= 255; len -= 255) {
+        *out++ = 255;
+    }
+    *out++ = len;
+    return out;
+}
+
+/* function to read a length written by putLength */
+static const unsigned char *getLength(const unsigned char *in, const unsigned char *end, size_t *len) {
+    while (in < end) {
+        unsigned char byte = *in++;
+        *len += byte;
+        if (byte < 255) {
+            return in;
+        }
+    }
+    return NULL;
+}
+
+/* function to compress a block */
+static size_t blockEncode(const unsigned char *src, const size_t len, unsigned char *out) {
+    unsigned char *start = out;
+    uint32_t *table = calloc(1 << HASH_BITS, sizeof(uint32_t));  // position + 1 of the last 4 bytes with each hash
+    size_t anchor = 0;  // first literal not yet written
+    size_t i = 0;
+    while (table != NULL && len > TAIL && i < len - TAIL) {
+        uint32_t seq = read32(src + i);
+        uint32_t hash = (seq * 2654435761u) >> (32 - HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = i + 1;
+        if (candidate == 0 || i - (candidate - 1) > WINDOW || read32(src + candidate - 1) != seq) {
+            i += 1 + ((i - anchor) >> 6);   // step faster through data that does not compress
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t matchLen = MIN_MATCH;
+        while (i + matchLen < len - TAIL / 2 && src[match + matchLen] == src[i + matchLen]) {
+            matchLen++;
+        }
+        size_t literals = i - anchor;
+        unsigned char *token = out++;
+        *token = (literals < 15 ? literals : 15) << 4 | (matchLen - MIN_MATCH < 15 ? matchLen - MIN_MATCH : 15);
+        if (literals >= 15) {
+            out = putLength(out, literals - 15);
+        }
+        memcpy(out, src + anchor, literals);
+        out += literals;
+        size_t offset = i - match;
+        *out++ = offset & 0xff;
+        *out++ = offset >> 8;
+        if (matchLen - MIN_MATCH >= 15) {
+            out = putLength(out, matchLen - MIN_MATCH - 15);
+        }
+        i += matchLen;
+        anchor = i;
+    }
+    free(table);
+    size_t literals = len - anchor;     // the rest, as literals (all of it if the table could not be made)
+    *out++ = (literals < 15 ? literals : 15) << 4;
+    if (literals >= 15) {
+        out = putLength(out, literals - 15);
+    }
+    memcpy(out, src + anchor, literals);
+    out += literals;
+    return out - start;
+}
+
+/* function to decode a block */
+static bool blockDecode(const unsigned char *in, const size_t len, unsigned char *out, const size_t size) {
+    const unsigned char *end = in + len;
+    size_t pos = 0;
+    while (in < end) {
+        unsigned char token = *in++;
+        size_t literals = token >> 4;
+        if (literals == 15 && (in = getLength(in, end, &literals)) == NULL) {
+            return false;
+        }
+        if (literals > (size_t) (end - in) || literals > size - pos) {
+            return false;
+        }
+        memcpy(out + pos, in, literals);
+        in += literals;
+        pos += literals;
+        if (in == end) {    // the last sequence has no match
+            break;
+        }
+        if (end - in < 2) {
+            return false;
+        }
+        size_t offset = in[0] | in[1] << 8;
+        in += 2;
+        size_t matchLen = (token & 0x0f);
+        if (matchLen == 15 && (in = getLength(in, end, &matchLen)) == NULL) {
+            return false;
+        }
+        matchLen += MIN_MATCH;
+        if (offset == 0 || offset > pos || matchLen > size - pos) {
+            return false;
+        }
+        unsigned char *from = out + pos - offset;
+        if (offset >= matchLen) {
+            memcpy(out + pos, from, matchLen);
+        } else {    // the match overlaps what it writes: copy forward a byte at a time
+            for (size_t k = 0; k < matchLen; k++) {
+                out[pos + k] = from[k];
+            }
+        }
+        pos += matchLen;
+    }
+    return pos == size;
+}
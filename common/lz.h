@@ -0,0 +1,73 @@
+/**
+ * @file lz.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief lz provides a small LZ77 block codec in the style of LZ4 (byte aligned sequences of literals and
+ *        matches, 64 KB window) and a frame around it, used to compress saved pages one at a time
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __LZ_H_
+#define __LZ_H_
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LzMagic "\0TSELZ1"  // first bytes of a frame; html never holds a '\0', so a frame is told apart from html
+#define LzMagicLen 7        // bytes of LzMagic
+
+#ifndef LzLimit
+#define LzLimit (64L << 20) // largest decoded size accepted from a frame
+#endif
+
+/**
+ * @brief function to compress data into a frame: LzMagic, the decoded size (a varint), then the compressed block
+ *
+ * @param data bytes to compress
+ * @param len number of bytes
+ * @param frameLen pointer to store the length of the frame
+ * @return char* frame (malloc'd), or NULL on failure or if len is over LzLimit
+ * do
+ *  - find matches of 4 bytes or more through a hash table of the last position of each 4 byte sequence
+ *  - take each match greedily, extended as far as it goes
+ */
+char *lzEncode(const char *data, const size_t len, size_t *frameLen);
+
+/**
+ * @brief function to tell whether bytes start with a frame made by lzEncode
+ *
+ */
+bool lzIsFrame(const char *data, const size_t len);
+
+/**
+ * @brief function to get the decoded size of a frame
+ *
+ * @param frame frame made by lzEncode
+ * @param len length of the frame
+ * @return long decoded size, or -1 if the frame is malformed
+ */
+long lzFrameSize(const char *frame, const size_t len);
+
+/**
+ * @brief function to decode a frame into a buffer
+ *
+ * @param frame frame made by lzEncode
+ * @param len length of the frame
+ * @param out buffer of at least lzFrameSize + 1 bytes; the data is followed by a '\0'
+ * @return long decoded size, or -1 if the frame is corrupt (every offset and length is checked)
+ */
+long lzDecodeInto(const char *frame, const size_t len, char *out);
+
+/**
+ * @brief function to decode a frame
+ *
+ * @param frame frame made by lzEncode
+ * @param len length of the frame
+ * @param outLen pointer to store the decoded size (may be NULL)
+ * @return char* decoded data (malloc'd, with a '\0' after it), or NULL if the frame is corrupt
+ */
+char *lzDecode(const char *frame, const size_t len, size_t *outLen);
+
+#endif
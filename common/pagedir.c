@@ -9,6 +9,8 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L     // strdup
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -19,6 +21,7 @@
 #include "webpage.h"
 #include "mem.h"
 #include "file.h"
+#include "lz.h"
 
 /* function to initialize the pageDirectory and create a .crawler file */
 /* see pagedir.h for more information */
@@ -67,13 +70,102 @@ void pageDirSave(webpage_t *page, const char* pageDirectory, int fn) {
     fclose(fp);
 }
 
+/* function to save a webpage with its html compressed */
+/* see pagedir.h for more information */
+void pageDirSaveCompressed(webpage_t *page, const char* pageDirectory, const int fn) {
+    if (page == NULL || pageDirectory == NULL || fn < 0 || webpage_getHTML(page) == NULL) {   // ensure args are valid
+        return;
+    }
+    size_t frameLen;
+    char *frame = lzEncode(webpage_getHTML(page), strlen(webpage_getHTML(page)), &frameLen);
+    if (frame == NULL) {
+        return;
+    }
+    char fileName[strlen(pageDirectory) + (int) log10(fn + 1) + 3];
+    sprintf(fileName, "%s/%d", pageDirectory, fn);
+    FILE *fp = fopen(fileName, "w");
+    if (fp != NULL) {
+        fprintf(fp, "%s\n%d\n", webpage_getURL(page), webpage_getDepth(page));
+        fwrite(frame, 1, frameLen, fp);
+        fclose(fp);
+    }
+    free(frame);
+}
+
+/* function to record the validators of a saved page in the .validators file */
+/* see pagedir.h for more information */
+void pageDirSaveValidators(const char *pageDirectory, const int fn, const http_validators_t *validators) {
+    if (pageDirectory == NULL || validators == NULL || fn < 1) {   // ensure args are valid
+        return;
+    }
+    if (validators->etag == NULL && validators->lastModified == NULL) {    // nothing to send next time
+        return;
+    }
+    char fileName[strlen(pageDirectory) + 13];  // '/' + ".validators" + null
+    sprintf(fileName, "%s/.validators", pageDirectory);
+    FILE *fp = fopen(fileName, "a");
+    if (fp == NULL) {
+        return;
+    }
+    fprintf(fp, "%d\t%s\t%s\n", fn, validators->etag == NULL ? "" : validators->etag,
+            validators->lastModified == NULL ? "" : validators->lastModified);
+    fclose(fp);     // the line is flushed in one write
+}
+
+/* function to load the validators recorded with pageDirSaveValidators */
+/* see pagedir.h for more information */
+int pageDirLoadValidators(const char *pageDirectory, http_validators_t **validators) {
+    if (pageDirectory == NULL || validators == NULL) {  // ensure args are valid
+        return 0;
+    }
+    *validators = NULL;
+    char fileName[strlen(pageDirectory) + 13];
+    sprintf(fileName, "%s/.validators", pageDirectory);
+    FILE *fp = fopen(fileName, "r");
+    if (fp == NULL) {
+        return 0;
+    }
+    int count = 0;
+    char *line;
+    while ((line = file_readLine(fp)) != NULL) {
+        char *etag = strchr(line, '\t');
+        char *lastModified = etag == NULL ? NULL : strchr(etag + 1, '\t');
+        int fn = atoi(line);
+        if (lastModified == NULL || fn < 1) {  // not a validators line
+            mem_free(line);
+            continue;
+        }
+        *etag++ = '\0';
+        *lastModified++ = '\0';
+        if (fn >= count) {  // grow the array to hold fn
+            int grown = count == 0 ? 1024 : count;
+            while (grown <= fn) grown *= 2;
+            http_validators_t *array = realloc(*validators, grown * sizeof(http_validators_t));
+            if (array == NULL) {
+                mem_free(line);
+                break;
+            }
+            memset(array + count, 0, (grown - count) * sizeof(http_validators_t));
+            *validators = array;
+            count = grown;
+        }
+        http_validators_t *entry = &(*validators)[fn];  // a later line replaces an earlier one
+        httpValidatorsClear(entry);
+        entry->etag = *etag == '\0' ? NULL : strdup(etag);
+        entry->lastModified = *lastModified == '\0' ? NULL : strdup(lastModified);
+        mem_free(line);
+    }
+    fclose(fp);
+    return count;
+}
+
 /* function to load a file that is in a crawler directory into a webpage object */
 /* see pagedir.h for more information */
 int pageDirLoad(webpage_t **page, const char* pageDirectory, int docID) {
     if (page == NULL || pageDirectory == NULL || docID < 1) {   // validate arguments
         return 0;
     }
-    char docFile[strlen(pageDirectory) + (int) log10(docID) + 1];
+    char docFile[strlen(pageDirectory) + (int) log10(docID) + 3]; // +1 for log+1, +1 for '/' and +1 for null pointer at end
     sprintf(docFile, "%s/%d", pageDirectory, docID);
     FILE *fp = fopen(docFile, "r");
     if (fp == NULL) {
@@ -81,8 +173,31 @@ int pageDirLoad(webpage_t **page, const char* pageDirectory, int docID) {
     }
     char *url = file_readLine(fp);  // url for webpage
     char *depthS = file_readLine(fp);   // depth string
-    char *html = file_readFile(fp);
-    int depth = atoi(depthS);   // webpage depth
+    char *html = NULL;
+    long start = ftell(fp);
+    if (url != NULL && depthS != NULL && start >= 0 && fseek(fp, 0, SEEK_END) == 0) {   // read the rest at once
+        size_t len = ftell(fp) - start;
+        html = malloc(len + 1);
+        if (html != NULL && (fseek(fp, start, SEEK_SET) != 0 || fread(html, 1, len, fp) != len)) {
+            free(html);
+            html = NULL;
+        } else if (html != NULL) {
+            html[len] = '\0';
+        }
+        if (html != NULL && lzIsFrame(html, len)) {     // saved by pageDirSaveCompressed
+            long size = lzFrameSize(html, len);
+            char *plain = size < 0 ? NULL : malloc(size + 2);
+            if (plain != NULL && lzDecodeInto(html, len, plain) == size) {
+                strcpy(plain + size, "\n");  // load as if pageDirSave wrote it: with the newline after the html
+            } else {
+                free(plain);
+                plain = NULL;
+            }
+            free(html);
+            html = plain;
+        }
+    }
+    int depth = depthS == NULL ? 0 : atoi(depthS);   // webpage depth
     mem_free(depthS);   // free depth string
     *page = webpage_new(url, depth, html);    // create webpage
     if (*page == NULL) { // ensure calloc was successful
@@ -116,12 +231,38 @@ bool pageDirValidate(const char* pageDirectory) {
     return true;
 }
 
+/* function to find the end of the page files in a directory */
+/* see pagedir.h for more information */
+int pageDirEnd(const char *pageDirectory) {
+    if (pageDirectory == NULL) {    // ensure args are valid
+        return 0;
+    }
+    DIR *dir = opendir(pageDirectory);
+    if (dir == NULL) {
+        return 0;
+    }
+    int end = 1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (name[0] < '1' || name[0] > '9' || strspn(name, "0123456789") != strlen(name) || strlen(name) > 9) {
+            continue;   // not a page file: dot files, and names that are not a plain id
+        }
+        int id = atoi(name);
+        if (id >= end) {
+            end = id + 1;
+        }
+    }
+    closedir(dir);
+    return end;
+}
+
 /* function to get the url of the webpage from a doc file */
 /* see pagedir.h for more information */
 char *getPageUrl(const char *pageDirectory, const int docID) {
     if (pageDirectory == NULL || docID < 0) return NULL;
     if (!pageDirValidate(pageDirectory)) return NULL;
-    char docFile[strlen(pageDirectory) + (int) log10(docID) + 1];
+    char docFile[strlen(pageDirectory) + (int) log10(docID) + 3]; // +1 for log+1, +1 for '/' and +1 for null pointer at end
     sprintf(docFile, "%s/%d", pageDirectory, docID);
     FILE *fp = fopen(docFile, "r");
     if (fp == NULL) {
@@ -12,6 +12,7 @@
 #ifndef __PAGE_DIR_H_
 #define __PAGE_DIR_H_
 #include <webpage.h>
+#include "http.h"
 
 /**
  * @brief function to initialize the pageDirectory and create a .crawler file
@@ -35,12 +36,48 @@ bool pageDirInit(const char *pageDirectory);
  */
 void pageDirSave(webpage_t *page, const char* pageDirectory, const int fn);
 
+/**
+ * @brief function to save a webpage as pageDirSave does, with its html compressed
+ * 
+ * @param page webpage_t struct
+ * @param pageDirectory path to page directory
+ * @param fn file id
+ * do
+ *  - write the url and depth lines as pageDirSave does, so getPageUrl reads the url with no decompression
+ *  - write the html as one lz frame (see lz.h) in place of the html line
+ */
+void pageDirSaveCompressed(webpage_t *page, const char* pageDirectory, const int fn);
+
+/**
+ * @brief function to record the validators (ETag and Last-Modified) of a saved page in the .validators file
+ * 
+ * @param pageDirectory path to page directory
+ * @param fn file id of the page
+ * @param validators validators of the response the page was saved from
+ * do
+ *  - nothing if pageDirectory or validators is NULL, fn < 1 or validators holds neither header
+ *  - append a "fn<TAB>etag<TAB>lastModified" line; a later line for the same fn replaces earlier ones
+ *  - each line is written with a single write to a file opened for appending, so workers may call this at once
+ */
+void pageDirSaveValidators(const char *pageDirectory, const int fn, const http_validators_t *validators);
+
+/**
+ * @brief function to load the validators recorded with pageDirSaveValidators
+ * 
+ * @param pageDirectory path to page directory
+ * @param validators pointer to store a malloc'd array of validators indexed by file id (empty where none is recorded);
+ *  the caller clears every entry with httpValidatorsClear and frees the array
+ * @return int number of entries in the array (more than the largest file id), or 0 if none are recorded
+ */
+int pageDirLoadValidators(const char *pageDirectory, http_validators_t **validators);
+
 /**
  * @brief function to load a file that is in a crawler directory into a webpage object
  * 
  * @param page pointer to webpage object pointer to load page into
  * @param pageDirectory  name of crawler directory where doc file is
  * @param docID name of docfile to load
+ * a page saved by pageDirSaveCompressed has its html decompressed
  * @return int
  * -1 if page file is invalid
  *  0  for other failures
@@ -57,6 +94,15 @@ int pageDirLoad(webpage_t **page, const char* pageDirectory, int docID);
  */
 bool pageDirValidate(const char* pageDirectory);
 
+/**
+ * @brief function to find the end of the page files in a directory
+ * 
+ * @param pageDirectory page directory of webpage files
+ * @return int one more than the largest file id in the directory (1 if it has none, 0 if it cannot be read)
+ * the directory is listed once, so ids missing part way (a page removed, or a crash between saves) do not end it
+ */
+int pageDirEnd(const char *pageDirectory);
+
 /**
  * @brief Get the Page Url for doc1d
  * 
@@ -0,0 +1,225 @@
+/**
+ * @file pagemap.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in pagemap.h (a memory mapped reader of the pages in a page directory)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _DEFAULT_SOURCE     // madvise
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "pagemap.h"
+#include "pagestore.h"
+#include "mem.h"
+#include "lz.h"
+
+struct pagemap {
+    char *pageDirectory;        // directory read (one file per page)
+    const char *data;           // mapped .pages of a packed store, or NULL
+    size_t dataLen;             // length of data
+    const unsigned char *table; // mapped .pageindex of a packed store, or NULL
+    size_t slots;               // slots in table
+    void *file;                 // mapped page file last asked for (one file per page), or NULL
+    size_t fileLen;             // length of file
+    char *plain;                // html of the last compressed page asked for (malloc'd), or NULL
+    size_t plainSize;           // size of plain
+    int end;                    // one more than the last docID, or 0 until it is looked for
+};
+
+/**
+ * @brief function to map a whole file read only
+ *
+ * @param path file to map
+ * @param len pointer to store the length of the file
+ * @return void* mapping, or NULL if the file cannot be opened, is empty or cannot be mapped
+ */
+static void *mapFile(const char *path, size_t *len);
+
+/**
+ * @brief function to fill in a view of a page record: "url\ndepth\nhtml\n", as pageDirSave writes a page file
+ *        (a compressed html is decoded into the reader's buffer, and the view of it points there)
+ *
+ */
+static bool recordView(pagemap_t *map, const char *record, const size_t len, page_view_t *view);
+
+/**
+ * @brief function to read a little endian integer from the table
+ *
+ */
+static uint64_t getLE(const unsigned char *buf, const int bytes);
+
+/* see pagemap.h for more information */
+pagemap_t *pagemapOpen(const char *pageDirectory) {
+    // validate arguments
+    if (pageDirectory == NULL) {
+        return NULL;
+    }
+    pagemap_t *map = mem_calloc(1, sizeof(pagemap_t));
+    if (map == NULL) {
+        return NULL;
+    }
+    map->pageDirectory = malloc(strlen(pageDirectory) + 1);
+    if (map->pageDirectory == NULL) {
+        pagemapClose(map);
+        return NULL;
+    }
+    strcpy(map->pageDirectory, pageDirectory);
+    if (!pagestoreExists(pageDirectory)) {  // one file per page: each is mapped when asked for
+        return map;
+    }
+    char path[strlen(pageDirectory) + 16];
+    size_t tableLen;
+    sprintf(path, "%s/.pageindex", pageDirectory);
+    map->table = mapFile(path, &tableLen);
+    sprintf(path, "%s/.pages", pageDirectory);
+    map->data = mapFile(path, &map->dataLen);
+    if (map->table == NULL || tableLen < PagestoreSlot
+        || memcmp(map->table, PagestoreMagic, strlen(PagestoreMagic)) != 0) {
+        pagemapClose(map);
+        return NULL;
+    }
+    map->slots = tableLen / PagestoreSlot;
+    if (map->data != NULL) {    // read front to back by the indexer
+        madvise((void *) map->data, map->dataLen, MADV_SEQUENTIAL);
+    }
+    return map;
+}
+
+/* see pagemap.h for more information */
+int pagemapGet(pagemap_t *map, const int docID, page_view_t *view) {
+    // validate arguments
+    if (map == NULL || view == NULL || docID < 1) {
+        return 0;
+    }
+    if (map->table != NULL) {   // packed store: the table says where the page is
+        if ((size_t) docID >= map->slots) {
+            return -1;
+        }
+        const unsigned char *slot = map->table + (size_t) docID * PagestoreSlot;
+        uint64_t offset = getLE(slot, 8);
+        uint64_t length = getLE(slot + 8, 4);
+        if ((getLE(slot + 12, 4) & PagestoreUsed) == 0 || offset > map->dataLen || length > map->dataLen - offset) {
+            return 0;
+        }
+        return recordView(map, map->data + offset, length, view) ? 1 : 0;
+    }
+    if (map->file != NULL) {    // one file per page: the last page's view ends here
+        munmap(map->file, map->fileLen);
+        map->file = NULL;
+    }
+    char path[strlen(map->pageDirectory) + 16];
+    sprintf(path, "%s/%d", map->pageDirectory, docID);
+    if (access(path, F_OK) != 0) {
+        return -1;
+    }
+    map->file = mapFile(path, &map->fileLen);
+    return map->file != NULL && recordView(map, map->file, map->fileLen, view) ? 1 : 0;
+}
+
+/* see pagemap.h for more information */
+int pagemapEnd(pagemap_t *map) {
+    if (map == NULL) {
+        return 0;
+    }
+    if (map->table != NULL) {
+        return map->slots > 0 ? map->slots : 1;
+    }
+    if (map->end == 0) {    // page files run from 1 up to the first missing one
+        char path[strlen(map->pageDirectory) + 16];
+        int docID = 1;
+        for (sprintf(path, "%s/%d", map->pageDirectory, docID); access(path, F_OK) == 0; docID++) {
+            sprintf(path, "%s/%d", map->pageDirectory, docID + 1);
+        }
+        map->end = docID;
+    }
+    return map->end;
+}
+
+/* see pagemap.h for more information */
+void pagemapClose(pagemap_t *map) {
+    if (map == NULL) {
+        return;
+    }
+    if (map->data != NULL) munmap((void *) map->data, map->dataLen);
+    if (map->table != NULL) munmap((void *) map->table, map->slots * PagestoreSlot);
+    if (map->file != NULL) munmap(map->file, map->fileLen);
+    free(map->pageDirectory);
+    free(map->plain);
+    mem_free(map);
+}
+
+/* function to map a whole file read only */
+static void *mapFile(const char *path, size_t *len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void *mapped = NULL;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        *len = info.st_size;
+    }
+    close(fd);  // the mapping keeps the file
+    return mapped == MAP_FAILED ? NULL : mapped;
+}
+
+/* function to fill in a view of a page record */
+static bool recordView(pagemap_t *map, const char *record, const size_t len, page_view_t *view) {
+    const char *end = record + len;
+    const char *depth = memchr(record, '\n', len);
+    const char *html = depth == NULL ? NULL : memchr(depth + 1, '\n', end - (depth + 1));
+    if (html == NULL) {
+        return false;
+    }
+    view->url = record;
+    view->urlLen = depth - record;
+    view->depth = 0;
+    for (const char *c = depth + 1; c < html && *c >= '0' && *c <= '9'; c++) {  // atoi, bounded by the line
+        view->depth = view->depth * 10 + (*c - '0');
+    }
+    view->html = html + 1;
+    view->htmlLen = end - view->html;
+    if (lzIsFrame(view->html, view->htmlLen)) {     // saved compressed: decode into the buffer kept across pages
+        long size = lzFrameSize(view->html, view->htmlLen);
+        if (size >= 0 && (size_t) size + 1 > map->plainSize) {
+            char *grown = realloc(map->plain, size + 1);
+            if (grown == NULL) {
+                return false;
+            }
+            map->plain = grown;
+            map->plainSize = size + 1;
+        }
+        if (size < 0 || lzDecodeInto(view->html, view->htmlLen, map->plain) < 0) {
+            return false;
+        }
+        view->html = map->plain;
+        view->htmlLen = size;
+        return true;
+    }
+    if (view->htmlLen > 0 && view->html[view->htmlLen - 1] == '\n') {  // drop the newline written after the html
+        view->htmlLen--;
+    }
+    return true;
+}
+
+/* function to read a little endian integer */
+static uint64_t getLE(const unsigned char *buf, const int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = value << 8 | buf[i];
+    }
+    return value;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file pagemap.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief pagemap provides a memory mapped reader of the pages in a page directory, handing out each page's url,
+ *        depth and html as views into the mapping rather than copies
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __PAGE_MAP_H_
+#define __PAGE_MAP_H_
+#include <stddef.h>
+
+/**
+ * @brief a page as it lies in the mapping; none of it is '\0' terminated
+ *
+ */
+typedef struct pageView {
+    const char *url;    // url of the page
+    size_t urlLen;      // length of url
+    int depth;          // depth of the page
+    const char *html;   // html of the page, without the newline saved after it
+    size_t htmlLen;     // length of html
+} page_view_t;
+
+/**
+ * @brief opaque type holding the mapped files of a page directory
+ *
+ */
+typedef struct pagemap pagemap_t;
+
+/**
+ * @brief function to open a page directory for reading through mappings
+ *
+ * @param pageDirectory crawler page directory, with one file per page or a packed store (see pagestore)
+ * @return pagemap_t* reader, or NULL on failure
+ * do
+ *  - map the data file and table of a packed store once, for the life of the reader
+ *  - otherwise map each page file when it is asked for
+ *  - decode compressed html (see lz.h) into one buffer kept across pages: the only copy made
+ */
+pagemap_t *pagemapOpen(const char *pageDirectory);
+
+/**
+ * @brief function to get a view of a page
+ *
+ * @param map reader
+ * @param docID id of the page
+ * @param view view to fill in; it stays valid until the next pagemapGet (one file per page, or a compressed page)
+ *        or pagemapClose (an uncompressed page of a store)
+ * @return int 1 on success, -1 if docID is past the last page, 0 if it has no page or cannot be read
+ *         (the same as pageDirLoad, so callers can stop at -1)
+ */
+int pagemapGet(pagemap_t *map, const int docID, page_view_t *view);
+
+/**
+ * @brief function to get one more than the last docID of the directory: the first docID pagemapGet gives -1 for
+ *
+ * @param map reader
+ * @return int end of the docIDs (found by looking for page files the first time, if the pages are one file each)
+ */
+int pagemapEnd(pagemap_t *map);
+
+/**
+ * @brief function to unmap and close a reader; views into it are no longer valid
+ *
+ * @param map reader (may be NULL)
+ */
+void pagemapClose(pagemap_t *map);
+
+#endif
@@ -0,0 +1,382 @@
+/**
+ * @file pagestore.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in pagestore.h (a packed page directory: data file and docID -> offset table)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#define _GNU_SOURCE     // pread, pwrite, pwritev
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "pagestore.h"
+#include "mem.h"
+#include "lz.h"
+
+enum { MAGIC_LEN = 8 };    // bytes of PagestoreMagic
+enum { URL_READ = 512 };    // bytes read to find the url line; a longer url is read with its page
+
+/**
+ * @brief where a page is in the data file
+ *
+ */
+typedef struct pageEntry {
+    uint64_t offset;    // start of the page record
+    uint32_t length;    // length of the record
+    bool used;          // false if the docID has no page
+} page_entry_t;
+
+struct pagestore {
+    int data;               // .pages
+    int table;              // .pageindex
+    bool writable;          // opened to append or create
+    pthread_mutex_t lock;   // guards the fields below
+    page_entry_t *entries;  // table, indexed by docID
+    int end;                // one more than the largest docID in the table
+    int capacity;           // room in entries
+    uint64_t dataEnd;       // end of the data file: where the next page goes
+};
+
+/**
+ * @brief function to make the path of a file of the store
+ *
+ */
+static void storePath(char *path, const char *pageDirectory, const char *name);
+
+/**
+ * @brief function to make room in the table for docID
+ *
+ */
+static bool storeReserve(pagestore_t *store, const int docID);
+
+/**
+ * @brief function to read the table file into memory
+ *
+ */
+static bool storeReadTable(pagestore_t *store);
+
+/**
+ * @brief function to read the record of a page
+ *
+ * @param store store
+ * @param docID id of the page
+ * @param limit read at most this many bytes (0 for the whole record)
+ * @param len pointer to store the number of bytes read
+ * @return char* bytes read (malloc'd, with a '\0' after them), or NULL if there is no page; *len is -1 past the end
+ */
+static char *storeRead(pagestore_t *store, const int docID, const size_t limit, long *len);
+
+/**
+ * @brief functions to write and read little endian integers
+ *
+ */
+static void putLE(unsigned char *buf, uint64_t value, const int bytes);
+static uint64_t getLE(const unsigned char *buf, const int bytes);
+
+/* see pagestore.h for more information */
+pagestore_t *pagestoreOpen(const char *pageDirectory, const pagestore_mode_t mode) {
+    // validate arguments
+    if (pageDirectory == NULL) {
+        return NULL;
+    }
+    char dataPath[strlen(pageDirectory) + 16], tablePath[strlen(pageDirectory) + 16];
+    storePath(dataPath, pageDirectory, ".pages");
+    storePath(tablePath, pageDirectory, ".pageindex");
+    int flags = mode == PAGESTORE_READ ? O_RDONLY : O_RDWR | O_CREAT | (mode == PAGESTORE_CREATE ? O_TRUNC : 0);
+    pagestore_t *store = mem_calloc(1, sizeof(pagestore_t));
+    if (store == NULL) {
+        return NULL;
+    }
+    store->data = open(dataPath, flags, 0644);
+    store->table = open(tablePath, flags, 0644);
+    store->writable = mode != PAGESTORE_READ;
+    pthread_mutex_init(&store->lock, NULL);
+    struct stat info;
+    if (store->data < 0 || store->table < 0 || fstat(store->data, &info) != 0 || !storeReadTable(store)) {
+        pagestoreClose(store);
+        return NULL;
+    }
+    store->dataEnd = info.st_size;
+    return store;
+}
+
+/* see pagestore.h for more information */
+bool pagestoreExists(const char *pageDirectory) {
+    if (pageDirectory == NULL) {
+        return false;
+    }
+    char tablePath[strlen(pageDirectory) + 16];
+    storePath(tablePath, pageDirectory, ".pageindex");
+    return access(tablePath, R_OK) == 0;
+}
+
+/* see pagestore.h for more information */
+bool pagestorePut(pagestore_t *store, webpage_t *page, const int docID, const bool compress) {
+    // validate arguments
+    if (store == NULL || !store->writable || page == NULL || docID < 1 || webpage_getURL(page) == NULL
+        || webpage_getHTML(page) == NULL) {
+        return false;
+    }
+    char head[32];
+    int headLen = snprintf(head, sizeof(head), "\n%d\n", webpage_getDepth(page));
+    struct iovec parts[4] = {   // the record, as pageDirSave writes a page file
+        { webpage_getURL(page), strlen(webpage_getURL(page)) },
+        { head, headLen },
+        { webpage_getHTML(page), strlen(webpage_getHTML(page)) },
+        { "\n", 1 }
+    };
+    char *frame = NULL;
+    if (compress) {     // as pageDirSaveCompressed writes it: the frame in place of the html line
+        frame = lzEncode(parts[2].iov_base, parts[2].iov_len, &parts[2].iov_len);
+        if (frame == NULL) {
+            return false;
+        }
+        parts[2].iov_base = frame;
+        parts[3].iov_len = 0;
+    }
+    size_t length = parts[0].iov_len + parts[1].iov_len + parts[2].iov_len + parts[3].iov_len;
+    if (length > UINT32_MAX) {
+        free(frame);
+        return false;
+    }
+    pthread_mutex_lock(&store->lock);
+    uint64_t offset = store->dataEnd;   // claim the space, then write without the lock
+    store->dataEnd += length;
+    pthread_mutex_unlock(&store->lock);
+    bool written = pwritev(store->data, parts, 4, offset) == (ssize_t) length;
+    free(frame);
+    if (!written) {
+        return false;
+    }
+    unsigned char slot[PagestoreSlot];
+    putLE(slot, offset, 8);
+    putLE(slot + 8, length, 4);
+    putLE(slot + 12, PagestoreUsed, 4);
+    pthread_mutex_lock(&store->lock);   // the page is whole: point the table at it
+    bool saved = storeReserve(store, docID) && pwrite(store->table, slot, PagestoreSlot, (off_t) docID * PagestoreSlot) == PagestoreSlot;
+    if (saved) {
+        store->entries[docID] = (page_entry_t) { offset, length, true };
+        if (docID >= store->end) {
+            store->end = docID + 1;
+        }
+    }
+    pthread_mutex_unlock(&store->lock);
+    return saved;
+}
+
+/* see pagestore.h for more information */
+int pagestoreLoad(pagestore_t *store, webpage_t **page, const int docID) {
+    // validate arguments
+    if (store == NULL || page == NULL || docID < 1) {
+        return 0;
+    }
+    long len;
+    char *record = storeRead(store, docID, 0, &len);
+    if (record == NULL) {
+        return len < 0 ? -1 : 0;
+    }
+    char *depth = strchr(record, '\n');
+    char *html = depth == NULL ? NULL : strchr(depth + 1, '\n');
+    char *url = html == NULL ? NULL : mem_malloc(depth - record + 1);
+    if (url == NULL) {
+        free(record);
+        return 0;
+    }
+    memcpy(url, record, depth - record);
+    url[depth - record] = '\0';
+    int pageDepth = atoi(depth + 1);
+    size_t htmlLen = record + len - (html + 1);
+    if (lzIsFrame(html + 1, htmlLen)) {     // a compressed page: decode it in place of the record
+        char *plain = lzDecode(html + 1, htmlLen, NULL);
+        free(record);
+        record = plain;
+    } else {
+        if (htmlLen > 0 && html[htmlLen] == '\n') {     // drop the newline written after the html
+            htmlLen--;
+        }
+        memmove(record, html + 1, htmlLen);     // the html takes over the record's buffer
+        record[htmlLen] = '\0';
+    }
+    if (record == NULL) {
+        mem_free(url);
+        return 0;
+    }
+    *page = webpage_new(url, pageDepth, record);
+    if (*page == NULL) {
+        mem_free(url);
+        free(record);
+        return 0;
+    }
+    return 1;
+}
+
+/* see pagestore.h for more information */
+char *pagestoreUrl(pagestore_t *store, const int docID) {
+    long len;
+    char *record = storeRead(store, docID, URL_READ, &len);
+    char *end = record == NULL ? NULL : strchr(record, '\n');
+    if (record != NULL && end == NULL) {    // a long url: read the whole record
+        free(record);
+        record = storeRead(store, docID, 0, &len);
+        end = record == NULL ? NULL : strchr(record, '\n');
+    }
+    if (end == NULL) {
+        free(record);
+        return NULL;
+    }
+    *end = '\0';
+    return record;
+}
+
+/* see pagestore.h for more information */
+int pagestoreEnd(const pagestore_t *store) {
+    return store == NULL ? 0 : store->end;
+}
+
+/* see pagestore.h for more information */
+bool pagestoreTruncate(pagestore_t *store, const int docID) {
+    if (store == NULL || !store->writable || docID < 1) {
+        return false;
+    }
+    pthread_mutex_lock(&store->lock);
+    bool cut = true;
+    if (docID < store->end) {
+        memset(store->entries + docID, 0, (store->end - docID) * sizeof(page_entry_t));
+        store->end = docID;
+        cut = ftruncate(store->table, (off_t) docID * PagestoreSlot) == 0;
+    }
+    uint64_t dataEnd = 0;   // save workers append out of docID order, so keep up to the last byte of any kept page
+    for (int id = 1; id < store->end; id++) {
+        if (store->entries[id].used && store->entries[id].offset + store->entries[id].length > dataEnd) {
+            dataEnd = store->entries[id].offset + store->entries[id].length;
+        }
+    }
+    if (dataEnd < store->dataEnd) {
+        cut = ftruncate(store->data, (off_t) dataEnd) == 0 && cut;
+        store->dataEnd = dataEnd;
+    }
+    pthread_mutex_unlock(&store->lock);
+    return cut;
+}
+
+/* see pagestore.h for more information */
+void pagestoreClose(pagestore_t *store) {
+    if (store == NULL) {
+        return;
+    }
+    if (store->data >= 0) close(store->data);
+    if (store->table >= 0) close(store->table);
+    pthread_mutex_destroy(&store->lock);
+    free(store->entries);
+    mem_free(store);
+}
+
+/* function to make the path of a file of the store */
+static void storePath(char *path, const char *pageDirectory, const char *name) {
+    sprintf(path, "%s/%s", pageDirectory, name);
+}
+
+/* function to make room in the table for docID */
+static bool storeReserve(pagestore_t *store, const int docID) {
+    if (docID < store->capacity) {
+        return true;
+    }
+    int capacity = store->capacity == 0 ? 1024 : store->capacity;
+    while (capacity <= docID) {
+        capacity *= 2;
+    }
+    page_entry_t *entries = realloc(store->entries, capacity * sizeof(page_entry_t));
+    if (entries == NULL) {
+        return false;
+    }
+    memset(entries + store->capacity, 0, (capacity - store->capacity) * sizeof(page_entry_t));
+    store->entries = entries;
+    store->capacity = capacity;
+    return true;
+}
+
+/* function to read the table file into memory */
+static bool storeReadTable(pagestore_t *store) {
+    struct stat info;
+    if (fstat(store->table, &info) != 0) {
+        return false;
+    }
+    if (info.st_size < PagestoreSlot) {  // a new store: write the magic
+        unsigned char first[PagestoreSlot] = { 0 };
+        memcpy(first, PagestoreMagic, MAGIC_LEN);
+        return store->writable && pwrite(store->table, first, PagestoreSlot, 0) == PagestoreSlot && storeReserve(store, 1)
+               && (store->end = 1) == 1;
+    }
+    int slots = info.st_size / PagestoreSlot;
+    unsigned char *buf = malloc((size_t) slots * PagestoreSlot);
+    if (buf == NULL || pread(store->table, buf, (size_t) slots * PagestoreSlot, 0) != (ssize_t) slots * PagestoreSlot
+        || memcmp(buf, PagestoreMagic, MAGIC_LEN) != 0 || !storeReserve(store, slots)) {
+        free(buf);
+        return false;
+    }
+    for (int docID = 1; docID < slots; docID++) {
+        const unsigned char *slot = buf + (size_t) docID * PagestoreSlot;
+        store->entries[docID].offset = getLE(slot, 8);
+        store->entries[docID].length = getLE(slot + 8, 4);
+        store->entries[docID].used = (getLE(slot + 12, 4) & PagestoreUsed) != 0;
+    }
+    store->end = slots;
+    free(buf);
+    return true;
+}
+
+/* function to read the record of a page */
+static char *storeRead(pagestore_t *store, const int docID, const size_t limit, long *len) {
+    *len = 0;
+    if (store == NULL || docID < 1) {
+        return NULL;
+    }
+    pthread_mutex_lock(&store->lock);
+    page_entry_t entry = { 0, 0, false };
+    if (docID >= store->end) {
+        *len = -1;
+    } else {
+        entry = store->entries[docID];
+    }
+    pthread_mutex_unlock(&store->lock);
+    if (!entry.used) {
+        return NULL;
+    }
+    size_t size = limit > 0 && limit < entry.length ? limit : entry.length;
+    char *record = malloc(size + 1);
+    if (record == NULL || pread(store->data, record, size, entry.offset) != (ssize_t) size) {
+        free(record);
+        return NULL;
+    }
+    record[size] = '\0';
+    *len = size;
+    return record;
+}
+
+/* function to write a little endian integer */
+static void putLE(unsigned char *buf, uint64_t value, const int bytes) {
+    for (int i = 0; i < bytes; i++, value >>= 8) {
+        buf[i] = value & 0xff;
+    }
+}
+
+/* function to read a little endian integer */
+static uint64_t getLE(const unsigned char *buf, const int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = value << 8 | buf[i];
+    }
+    return value;
+}
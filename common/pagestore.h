@@ -0,0 +1,113 @@
+/**
+ * @file pagestore.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief pagestore provides a packed page directory: every page in one append-only data file (.pages) and a
+ *        docID -> offset table (.pageindex), in place of one file per page
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __PAGE_STORE_H_
+#define __PAGE_STORE_H_
+#include <stdbool.h>
+#include <webpage.h>
+
+#define PagestoreMagic "TSEPAGE1"   // first 8 bytes of .pageindex (the rest of its first slot is 0)
+#define PagestoreSlot 16            // bytes per .pageindex slot, at docID * PagestoreSlot: offset (8), length (4), flags (4), little endian
+#define PagestoreUsed 1             // flag of a slot that points at a page
+
+/**
+ * @brief how a store is opened
+ *
+ */
+typedef enum pagestoreMode {
+    PAGESTORE_READ,     // read only; fails if the directory has no store
+    PAGESTORE_APPEND,   // read and add pages to the store in the directory, making one if there is none
+    PAGESTORE_CREATE    // start a new, empty store, dropping any store already in the directory
+} pagestore_mode_t;
+
+/**
+ * @brief opaque type holding the open files of a store and its docID -> offset table
+ *
+ */
+typedef struct pagestore pagestore_t;
+
+/**
+ * @brief function to open the store of a page directory
+ *
+ * @param pageDirectory page directory
+ * @param mode PAGESTORE_READ, PAGESTORE_APPEND or PAGESTORE_CREATE
+ * @return pagestore_t* open store, or NULL if it cannot be opened (or, for PAGESTORE_READ, does not exist)
+ * the table is read into memory once, so loading a page afterwards takes a single read of the data file
+ */
+pagestore_t *pagestoreOpen(const char *pageDirectory, const pagestore_mode_t mode);
+
+/**
+ * @brief function to tell whether a page directory holds a store
+ *
+ */
+bool pagestoreExists(const char *pageDirectory);
+
+/**
+ * @brief function to add a page to the store
+ *
+ * @param store store opened to append or create
+ * @param page page to save (url, depth and html)
+ * @param docID id of the page; saving an id again replaces the page
+ * @param compress true to write the html as an lz frame (see lz.h), as pageDirSaveCompressed does
+ * @return true if the page was written
+ * do
+ *  - write "url\ndepth\nhtml\n", as pageDirSave writes a page file, at the end of the data file
+ *  - then point the table entry of docID at it; until then readers see the page the entry held before
+ *  - the end of the data file is claimed under a lock and the writes need none, so save workers may call this at once
+ */
+bool pagestorePut(pagestore_t *store, webpage_t *page, const int docID, const bool compress);
+
+/**
+ * @brief function to load a page from the store
+ *
+ * @param store store
+ * @param page pointer to store the new webpage
+ * @param docID id of the page
+ * a compressed page has its html decompressed
+ * @return int 1 on success, -1 if docID is past the last page saved, 0 if it has no page or cannot be read
+ *         (the same as pageDirLoad, so callers can stop at -1)
+ */
+int pagestoreLoad(pagestore_t *store, webpage_t **page, const int docID);
+
+/**
+ * @brief function to get the url of a page in the store
+ *
+ * @param store store
+ * @param docID id of the page
+ * @return char* url (malloc'd) or NULL if there is no such page
+ */
+char *pagestoreUrl(pagestore_t *store, const int docID);
+
+/**
+ * @brief function to get one more than the largest docID in the store
+ *
+ */
+int pagestoreEnd(const pagestore_t *store);
+
+/**
+ * @brief function to drop the pages of docID and up from the store (a crawl resumed from a checkpoint saves them again)
+ *
+ * @param store store opened to append, with no pagestorePut in progress
+ * @param docID first id to drop (1 to empty the store)
+ * @return true if the table and the data file were cut
+ * the data file is cut after the last byte of the pages kept; records of dropped pages saved before that stay as dead bytes
+ */
+bool pagestoreTruncate(pagestore_t *store, const int docID);
+
+/**
+ * @brief function to close a store
+ *
+ * @param store store (may be NULL)
+ */
+void pagestoreClose(pagestore_t *store);
+
+#endif
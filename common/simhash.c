@@ -0,0 +1,231 @@
+/**
+ * @file simhash.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in simhash.h (SimHash fingerprints and a block indexed set of them)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "simhash.h"
+#include "wordscan.h"
+#include "mem.h"
+
+struct simset {
+    int maxDistance;    // fingerprints this many bits apart or fewer are near
+    int blocks;         // maxDistance + 1 blocks of bits, each indexed
+    int shift[SimhashMaxDistance + 1];  // first bit of each block
+    int width[SimhashMaxDistance + 1];  // bits in each block
+    uint64_t *fingerprints;     // fingerprints added
+    int *ids;                   // id of each fingerprint
+    int *next[SimhashMaxDistance + 1];  // per block, the next fingerprint in the same bucket, or -1
+    int *heads[SimhashMaxDistance + 1]; // per block, the last fingerprint added to each bucket, or -1
+    size_t count;       // fingerprints added
+    size_t capacity;    // room in fingerprints, ids and next
+    size_t buckets;     // buckets per block (a power of 2)
+};
+
+/**
+ * @brief function to hash a lower case word (FNV-1a, then a final mix so every bit is used)
+ *
+ */
+static uint64_t wordHash(const char *word, const size_t len);
+
+/**
+ * @brief function to get the bucket of a fingerprint in the table of a block
+ *
+ */
+static size_t bucketOf(const simset_t *set, const int block, const uint64_t fingerprint);
+
+/**
+ * @brief function to make the bucket tables larger and put every fingerprint back in them
+ *
+ */
+static bool simsetRehash(simset_t *set, const size_t buckets);
+
+/* see simhash.h for more information */
+uint64_t simhashPage(const char *html) {
+    if (html == NULL) {
+        return 0;
+    }
+    int votes[64] = { 0 };
+    char word[65];  // lower case copy of the word; longer words are hashed on their first 64 letters
+    size_t pos = 0, len = strlen(html);
+    word_span_t span;
+    while (wordscanNext(html, len, &pos, &span)) {  // the words the indexer keeps
+        uint64_t hash = wordHash(word, wordscanLower(html, &span, word, sizeof(word)));
+        for (int bit = 0; bit < 64; bit++) {
+            votes[bit] += (hash >> bit) & 1 ? 1 : -1;
+        }
+    }
+    uint64_t fingerprint = 0;
+    for (int bit = 0; bit < 64; bit++) {
+        if (votes[bit] > 0) {
+            fingerprint |= 1ULL << bit;
+        }
+    }
+    return fingerprint;
+}
+
+/* see simhash.h for more information */
+int simhashDistance(const uint64_t a, const uint64_t b) {
+    uint64_t bits = a ^ b;
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1) {
+        count++;
+    }
+    return count;
+}
+
+/* see simhash.h for more information */
+simset_t *simsetNew(const int maxDistance) {
+    // validate arguments
+    if (maxDistance < 0 || maxDistance > SimhashMaxDistance) {
+        return NULL;
+    }
+    simset_t *set = mem_calloc(1, sizeof(simset_t));
+    if (set == NULL) {
+        return NULL;
+    }
+    set->maxDistance = maxDistance;
+    set->blocks = maxDistance + 1;
+    for (int b = 0, shift = 0; b < set->blocks; b++) {  // 64 bits split as evenly as they go
+        set->shift[b] = shift;
+        set->width[b] = 64 / set->blocks + (b < 64 % set->blocks ? 1 : 0);
+        shift += set->width[b];
+    }
+    if (!simsetRehash(set, 256)) {
+        simsetDelete(set);
+        return NULL;
+    }
+    return set;
+}
+
+/* see simhash.h for more information */
+int simsetNear(const simset_t *set, const uint64_t fingerprint) {
+    if (set == NULL) {
+        return 0;
+    }
+    for (int b = 0; b < set->blocks; b++) {
+        uint64_t mask = (set->width[b] == 64 ? ~0ULL : (1ULL << set->width[b]) - 1) << set->shift[b];
+        for (int i = set->heads[b][bucketOf(set, b, fingerprint)]; i >= 0; i = set->next[b][i]) {
+            if (((set->fingerprints[i] ^ fingerprint) & mask) == 0
+                && simhashDistance(set->fingerprints[i], fingerprint) <= set->maxDistance) {
+                return set->ids[i];
+            }
+        }
+    }
+    return 0;
+}
+
+/* see simhash.h for more information */
+bool simsetAdd(simset_t *set, const uint64_t fingerprint, const int id) {
+    // validate arguments
+    if (set == NULL || id <= 0) {
+        return false;
+    }
+    if (set->count == set->capacity) {  // grow the arrays, and the tables with them
+        size_t capacity = set->capacity * 2;
+        uint64_t *fingerprints = realloc(set->fingerprints, capacity * sizeof(uint64_t));
+        if (fingerprints != NULL) set->fingerprints = fingerprints;
+        int *ids = realloc(set->ids, capacity * sizeof(int));
+        if (ids != NULL) set->ids = ids;
+        if (fingerprints == NULL || ids == NULL || !simsetRehash(set, set->buckets * 2)) {
+            return false;
+        }
+    }
+    size_t i = set->count++;
+    set->fingerprints[i] = fingerprint;
+    set->ids[i] = id;
+    for (int b = 0; b < set->blocks; b++) {
+        size_t bucket = bucketOf(set, b, fingerprint);
+        set->next[b][i] = set->heads[b][bucket];
+        set->heads[b][bucket] = i;
+    }
+    return true;
+}
+
+/* see simhash.h for more information */
+int simsetSize(const simset_t *set) {
+    return set == NULL ? 0 : set->count;
+}
+
+/* see simhash.h for more information */
+void simsetDelete(simset_t *set) {
+    if (set == NULL) {
+        return;
+    }
+    for (int b = 0; b < set->blocks; b++) {
+        free(set->next[b]);
+        free(set->heads[b]);
+    }
+    free(set->fingerprints);
+    free(set->ids);
+    mem_free(set);
+}
+
+/* function to hash a lower case word */
+static uint64_t wordHash(const char *word, const size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char) word[i];
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/* function to get the bucket of a fingerprint in the table of a block */
+static size_t bucketOf(const simset_t *set, const int block, const uint64_t fingerprint) {
+    uint64_t value = fingerprint >> set->shift[block];
+    if (set->width[block] < 64) {
+        value &= (1ULL << set->width[block]) - 1;
+    }
+    value *= 0x9e3779b97f4a7c15ULL;     // spread the block over the buckets
+    return (value >> 32) & (set->buckets - 1);
+}
+
+/* function to make the bucket tables larger and put every fingerprint back in them */
+static bool simsetRehash(simset_t *set, const size_t buckets) {
+    size_t capacity = buckets;  // one bucket per fingerprint the arrays hold
+    for (int b = 0; b < set->blocks; b++) {
+        int *next = realloc(set->next[b], capacity * sizeof(int));
+        if (next == NULL) {
+            return false;
+        }
+        set->next[b] = next;
+        int *heads = realloc(set->heads[b], buckets * sizeof(int));
+        if (heads == NULL) {
+            return false;
+        }
+        set->heads[b] = heads;
+    }
+    if (set->fingerprints == NULL) {
+        set->fingerprints = malloc(capacity * sizeof(uint64_t));
+        set->ids = malloc(capacity * sizeof(int));
+        if (set->fingerprints == NULL || set->ids == NULL) {
+            return false;
+        }
+    }
+    set->capacity = capacity;
+    set->buckets = buckets;
+    for (int b = 0; b < set->blocks; b++) {
+        memset(set->heads[b], -1, buckets * sizeof(int));
+        for (size_t i = 0; i < set->count; i++) {
+            size_t bucket = bucketOf(set, b, set->fingerprints[i]);
+            set->next[b][i] = set->heads[b][bucket];
+            set->heads[b][bucket] = i;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file simhash.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief simhash provides 64-bit SimHash fingerprints of pages and a set of them that finds near-duplicates
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __SIM_HASH_H_
+#define __SIM_HASH_H_
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SimhashMaxDistance
+#define SimhashMaxDistance 7 // largest Hamming distance a simset_t can search for
+#endif
+
+/**
+ * @brief opaque type holding fingerprints, indexed by blocks of their bits
+ *
+ */
+typedef struct simset simset_t;
+
+/**
+ * @brief function to compute the SimHash fingerprint of a page
+ *
+ * @param html html of the page
+ * @return uint64_t fingerprint; pages sharing most of their words have fingerprints a few bits apart
+ * do
+ *  - read the words of the page as webpage_getNextWord does (letters only, tags skipped), keeping those of
+ *    3 or more letters in lower case, as the indexer does
+ *  - add each word's 64-bit hash to a vote per bit (+1 if the bit is set, -1 if not), once per occurrence
+ *  - set the bits whose vote is positive
+ */
+uint64_t simhashPage(const char *html);
+
+/**
+ * @brief function to count the bits two fingerprints differ in
+ *
+ */
+int simhashDistance(const uint64_t a, const uint64_t b);
+
+/**
+ * @brief function to make a new, empty set of fingerprints
+ *
+ * @param maxDistance Hamming distance at or under which two fingerprints are near (0 to SimhashMaxDistance)
+ * @return simset_t* new set or NULL on failure
+ */
+simset_t *simsetNew(const int maxDistance);
+
+/**
+ * @brief function to find a fingerprint near one given
+ *
+ * @param set set
+ * @param fingerprint fingerprint to look for
+ * @return int id the near fingerprint was added with, or 0 if none is within maxDistance bits
+ * the bits are split into maxDistance + 1 blocks: fingerprints that near agree on at least one block, so only
+ * fingerprints sharing a block with this one are compared
+ */
+int simsetNear(const simset_t *set, const uint64_t fingerprint);
+
+/**
+ * @brief function to add a fingerprint
+ *
+ * @param set set
+ * @param fingerprint fingerprint to add
+ * @param id id to hand back when a fingerprint near it is looked for (> 0)
+ * @return true if added
+ */
+bool simsetAdd(simset_t *set, const uint64_t fingerprint, const int id);
+
+/**
+ * @brief function to get the number of fingerprints added
+ *
+ */
+int simsetSize(const simset_t *set);
+
+/**
+ * @brief function to delete a set
+ *
+ * @param set set (may be NULL)
+ */
+void simsetDelete(simset_t *set);
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file urlset.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in urlset.h (a Bloom filter in front of an open addressing fingerprint table)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "urlset.h"
+#include "mem.h"
+
+enum { BLOOM_HASHES = 4, BLOOM_BITS_PER_SLOT = 8 };    // ~11 bits per url at the highest load: about 1% false positives
+
+struct urlset {
+    uint64_t *table;    // fingerprints; 0 marks an empty slot
+    size_t capacity;    // slots in table (a power of 2)
+    size_t count;       // fingerprints in table
+    uint64_t *bloom;    // Bloom filter bits, BLOOM_BITS_PER_SLOT per table slot
+    size_t bloomBits;   // bits in the filter (a power of 2)
+};
+
+/**
+ * @brief function to allocate the table and the filter for capacity slots and add every fingerprint of old
+ *
+ */
+static bool urlsetResize(urlset_t *set, const size_t capacity);
+
+/**
+ * @brief function to tell whether the filter may hold a fingerprint, adding it if add is true
+ *
+ */
+static bool bloomTest(urlset_t *set, const uint64_t fingerprint, const bool add);
+
+/**
+ * @brief function to put a fingerprint known to be absent into the table
+ *
+ */
+static void tablePut(urlset_t *set, const uint64_t fingerprint);
+
+/* function to make a new, empty set */
+/* see urlset.h for more information */
+urlset_t *urlsetNew(const int expected) {
+    urlset_t *set = mem_calloc(1, sizeof(urlset_t));
+    if (set == NULL) {
+        return NULL;
+    }
+    size_t capacity = 64;
+    while (expected > 0 && capacity < (size_t) expected * 2) {    // keep the table under half full
+        capacity *= 2;
+    }
+    if (!urlsetResize(set, capacity)) {
+        mem_free(set);
+        return NULL;
+    }
+    return set;
+}
+
+/* function to get the fingerprint of a url (a 64-bit hash, never 0) */
+/* see urlset.h for more information */
+uint64_t urlsetFingerprint(const char *url) {
+    uint64_t hash = 0xcbf29ce484222325ULL;     // FNV-1a, then a final mix so the low bits are well spread
+    for (const unsigned char *c = (const unsigned char *) url; c != NULL && *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash == 0 ? 1 : hash;
+}
+
+/* function to add a fingerprint to the set */
+/* see urlset.h for more information */
+int urlsetInsertFingerprint(urlset_t *set, const uint64_t fingerprint) {
+    if (set == NULL || fingerprint == 0) {  // validate arguments
+        return -1;
+    }
+    if (bloomTest(set, fingerprint, false)) {   // maybe seen: the table decides
+        size_t mask = set->capacity - 1;
+        for (size_t i = fingerprint & mask; set->table[i] != 0; i = (i + 1) & mask) {
+            if (set->table[i] == fingerprint) {
+                return 0;
+            }
+        }
+    }
+    if ((set->count + 1) * 10 > set->capacity * 7 && !urlsetResize(set, set->capacity * 2)) { // keep load under 70%
+        return -1;
+    }
+    tablePut(set, fingerprint);
+    return 1;
+}
+
+/* function to add a url to the set */
+/* see urlset.h for more information */
+int urlsetInsert(urlset_t *set, const char *url) {
+    return url == NULL ? -1 : urlsetInsertFingerprint(set, urlsetFingerprint(url));
+}
+
+/* function to tell whether a url is in the set */
+/* see urlset.h for more information */
+bool urlsetContains(urlset_t *set, const char *url) {
+    if (set == NULL || url == NULL) {   // validate arguments
+        return false;
+    }
+    uint64_t fingerprint = urlsetFingerprint(url);
+    if (!bloomTest(set, fingerprint, false)) {
+        return false;
+    }
+    size_t mask = set->capacity - 1;
+    for (size_t i = fingerprint & mask; set->table[i] != 0; i = (i + 1) & mask) {
+        if (set->table[i] == fingerprint) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* function to get the number of urls in the set */
+/* see urlset.h for more information */
+int urlsetSize(urlset_t *set) {
+    return set == NULL ? 0 : (int) set->count;
+}
+
+/* function to write every fingerprint of a set to an open file */
+/* see urlset.h for more information */
+bool urlsetSave(urlset_t *set, FILE *fp) {
+    if (set == NULL || fp == NULL) {    // validate arguments
+        return false;
+    }
+    fprintf(fp, "%zu\n", set->count);
+    for (size_t i = 0; i < set->capacity; i++) {
+        if (set->table[i] != 0) {
+            fprintf(fp, "%" PRIx64 "\n", set->table[i]);
+        }
+    }
+    return !ferror(fp);
+}
+
+/* function to read fingerprints written by urlsetSave from an open file into a set */
+/* see urlset.h for more information */
+bool urlsetLoad(urlset_t *set, FILE *fp) {
+    if (set == NULL || fp == NULL) {    // validate arguments
+        return false;
+    }
+    size_t count;
+    if (fscanf(fp, "%zu", &count) != 1) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint64_t fingerprint;
+        if (fscanf(fp, "%" SCNx64, &fingerprint) != 1 || urlsetInsertFingerprint(set, fingerprint) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* function to delete a set */
+/* see urlset.h for more information */
+void urlsetDelete(urlset_t *set) {
+    if (set == NULL) {
+        return;
+    }
+    mem_free(set->table);
+    mem_free(set->bloom);
+    mem_free(set);
+}
+
+/* function to allocate the table and the filter for capacity slots and add every fingerprint of old */
+static bool urlsetResize(urlset_t *set, const size_t capacity) {
+    uint64_t *table = mem_calloc(capacity, sizeof(uint64_t));
+    size_t bloomBits = capacity * BLOOM_BITS_PER_SLOT;
+    uint64_t *bloom = mem_calloc(bloomBits / 64, sizeof(uint64_t));
+    if (table == NULL || bloom == NULL) {
+        if (table != NULL) mem_free(table);
+        if (bloom != NULL) mem_free(bloom);
+        return false;
+    }
+    uint64_t *old = set->table;
+    size_t oldCapacity = set->capacity;
+    if (set->bloom != NULL) mem_free(set->bloom);
+    set->table = table;
+    set->capacity = capacity;
+    set->bloom = bloom;
+    set->bloomBits = bloomBits;
+    set->count = 0;
+    for (size_t i = 0; i < oldCapacity; i++) {  // the filter is rebuilt from the fingerprints themselves
+        if (old[i] != 0) {
+            tablePut(set, old[i]);
+        }
+    }
+    if (old != NULL) mem_free(old);
+    return true;
+}
+
+/* function to tell whether the filter may hold a fingerprint, adding it if add is true */
+static bool bloomTest(urlset_t *set, const uint64_t fingerprint, const bool add) {
+    // double hashing: bit i is h1 + i * h2; h1 is rotated so it does not follow the table slot (the low bits)
+    uint64_t h1 = (fingerprint << 29) | (fingerprint >> 35), h2 = (fingerprint >> 32) | 1;
+    size_t mask = set->bloomBits - 1;
+    bool present = true;
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        size_t bit = (h1 + i * h2) & mask;
+        uint64_t word = 1ULL << (bit & 63);
+        if (!(set->bloom[bit >> 6] & word)) {
+            present = false;
+            if (!add) {
+                return false;
+            }
+            set->bloom[bit >> 6] |= word;
+        }
+    }
+    return present;
+}
+
+/* function to put a fingerprint known to be absent into the table */
+static void tablePut(urlset_t *set, const uint64_t fingerprint) {
+    size_t mask = set->capacity - 1;
+    size_t i = fingerprint & mask;
+    while (set->table[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    set->table[i] = fingerprint;
+    set->count++;
+    bloomTest(set, fingerprint, true);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file urlset.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief urlset provides the crawler's set of seen urls: a Bloom filter in front of a table of 64-bit url fingerprints
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __URL_SET_H_
+#define __URL_SET_H_
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief opaque type holding the Bloom filter and the fingerprint table
+ *
+ */
+typedef struct urlset urlset_t;
+
+/**
+ * @brief function to make a new, empty set
+ *
+ * @param expected number of urls expected; the set grows past it
+ * @return urlset_t* new set or NULL on failure
+ */
+urlset_t *urlsetNew(const int expected);
+
+/**
+ * @brief function to get the fingerprint of a url (a 64-bit hash, never 0)
+ *
+ * @param url url to hash
+ * @return uint64_t fingerprint; two urls are taken to be the same if their fingerprints are equal
+ * needs no lock, so callers sharing a set may hash before taking theirs
+ */
+uint64_t urlsetFingerprint(const char *url);
+
+/**
+ * @brief function to add a fingerprint to the set
+ *
+ * @param set set
+ * @param fingerprint fingerprint from urlsetFingerprint
+ * @return int 1 if the fingerprint was not in the set and has been added, 0 if it was already in the set,
+ * -1 if set is NULL, fingerprint is 0 or the table could not grow (the fingerprint is then not added)
+ * do
+ *  - check the Bloom filter first: most new urls are told apart there without touching the table
+ *  - otherwise probe the open addressing table of fingerprints
+ */
+int urlsetInsertFingerprint(urlset_t *set, const uint64_t fingerprint);
+
+/**
+ * @brief function to add a url to the set; same as urlsetInsertFingerprint(set, urlsetFingerprint(url))
+ *
+ * @param set set
+ * @param url url to add
+ * @return int 1 if the url was not in the set and has been added, 0 if it was already in the set, -1 on failure
+ */
+int urlsetInsert(urlset_t *set, const char *url);
+
+/**
+ * @brief function to tell whether a url is in the set
+ *
+ * @param set set
+ * @param url url to look for
+ * @return true if it is in the set
+ */
+bool urlsetContains(urlset_t *set, const char *url);
+
+/**
+ * @brief function to get the number of urls in the set
+ *
+ * @param set set
+ * @return int number of urls (0 if set is NULL)
+ */
+int urlsetSize(urlset_t *set);
+
+/**
+ * @brief function to write every fingerprint of a set to an open file
+ *
+ * @param set set
+ * @param fp file open for writing
+ * @return true if the set was written
+ * writes a line with the number of fingerprints, then one fingerprint per line in hex
+ */
+bool urlsetSave(urlset_t *set, FILE *fp);
+
+/**
+ * @brief function to read fingerprints written by urlsetSave from an open file into a set
+ *
+ * @param set set to add them to
+ * @param fp file open for reading, positioned where urlsetSave started writing
+ * @return true if every fingerprint was read
+ */
+bool urlsetLoad(urlset_t *set, FILE *fp);
+
+/**
+ * @brief function to delete a set
+ *
+ * @param set set to delete
+ */
+void urlsetDelete(urlset_t *set);
+
+#endif
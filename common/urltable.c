@@ -0,0 +1,208 @@
+/**
+ * @file urltable.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in urltable.h (a docID -> url table of offsets and a string blob)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "urltable.h"
+#include "mem.h"
+
+enum { MAGIC_LEN = 8, HEADER = 16 };    // magic, then the number of ids and 4 bytes kept at 0
+
+struct urltable {
+    uint32_t *offsets;      // start of the url of each id in blob, and one more for the end (built table)
+    char *blob;             // urls, each followed by a '\0' (built table)
+    size_t blobLen;         // bytes used in blob
+    size_t blobSize;        // size of blob
+    int end;                // one more than the largest id
+    int capacity;           // room in offsets
+    const unsigned char *mapped;    // mapped file (loaded table), or NULL
+    size_t mappedLen;               // length of the mapping
+    const unsigned char *table;     // offsets in the mapping
+    const char *strings;            // urls in the mapping
+};
+
+/**
+ * @brief functions to write and read 4 byte little endian integers
+ *
+ */
+static void putLE32(unsigned char *buf, const uint32_t value);
+static uint32_t getLE32(const unsigned char *buf);
+
+/* see urltable.h for more information */
+urltable_t *urltableNew(void) {
+    urltable_t *table = mem_calloc(1, sizeof(urltable_t));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->capacity = 1024;
+    table->offsets = calloc(table->capacity, sizeof(uint32_t));
+    if (table->offsets == NULL) {
+        urltableDelete(table);
+        return NULL;
+    }
+    table->end = 1;     // there is no id 0
+    return table;
+}
+
+/* see urltable.h for more information */
+bool urltableAdd(urltable_t *table, const int docID, const char *url, const size_t len) {
+    // validate arguments
+    if (table == NULL || table->mapped != NULL || url == NULL || docID < table->end || memchr(url, '\0', len) != NULL) {
+        return false;
+    }
+    if (docID + 1 >= table->capacity) {    // room for the offsets of docID and the end
+        int capacity = table->capacity;
+        while (capacity <= docID + 1) capacity *= 2;
+        uint32_t *offsets = realloc(table->offsets, capacity * sizeof(uint32_t));
+        if (offsets == NULL) {
+            return false;
+        }
+        table->offsets = offsets;
+        table->capacity = capacity;
+    }
+    if (table->blobLen + len + 1 > table->blobSize) {
+        size_t size = table->blobSize == 0 ? 65536 : table->blobSize;
+        while (size < table->blobLen + len + 1) size *= 2;
+        char *blob = size > UINT32_MAX ? NULL : realloc(table->blob, size);   // offsets are 4 bytes
+        if (blob == NULL) {
+            return false;
+        }
+        table->blob = blob;
+        table->blobSize = size;
+    }
+    for (int id = table->end; id < docID; id++) {   // ids skipped get an empty range
+        table->offsets[id] = table->blobLen;
+    }
+    table->offsets[docID] = table->blobLen;
+    memcpy(table->blob + table->blobLen, url, len);
+    table->blob[table->blobLen + len] = '\0';
+    table->blobLen += len + 1;
+    table->end = docID + 1;
+    return true;
+}
+
+/* see urltable.h for more information */
+bool urltableSave(const urltable_t *table, const char *fn) {
+    // validate arguments
+    if (table == NULL || table->mapped != NULL || fn == NULL) {
+        return false;
+    }
+    FILE *fp = fopen(fn, "w");
+    if (fp == NULL) {
+        return false;
+    }
+    unsigned char header[HEADER] = { 0 };
+    memcpy(header, UrltableMagic, MAGIC_LEN);
+    putLE32(header + MAGIC_LEN, table->end);
+    bool written = fwrite(header, 1, HEADER, fp) == HEADER;
+    unsigned char offset[4];
+    for (int id = 0; written && id <= table->end; id++) {  // id 0 starts at 0, and the last entry is the end
+        putLE32(offset, id == 0 ? 0 : id == table->end ? table->blobLen : table->offsets[id]);
+        written = fwrite(offset, 1, sizeof(offset), fp) == sizeof(offset);
+    }
+    written = written && (table->blobLen == 0 || fwrite(table->blob, 1, table->blobLen, fp) == table->blobLen);
+    return fclose(fp) == 0 && written;
+}
+
+/* see urltable.h for more information */
+urltable_t *urltableLoad(const char *fn) {
+    if (fn == NULL) {
+        return NULL;
+    }
+    int fd = open(fn, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= HEADER) {
+        mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return NULL;
+    }
+    const unsigned char *file = mapped;
+    size_t len = info.st_size;
+    uint32_t end = getLE32(file + MAGIC_LEN);
+    size_t tableLen = ((size_t) end + 1) * 4;
+    // the table must fit, its last offset must be the length of the urls, and they must end with a '\0'
+    if (memcmp(file, UrltableMagic, MAGIC_LEN) != 0 || end < 1 || end > INT32_MAX || tableLen > len - HEADER
+        || getLE32(file + HEADER + tableLen - 4) != len - HEADER - tableLen
+        || (len > HEADER + tableLen && file[len - 1] != '\0')) {
+        munmap(mapped, len);
+        return NULL;
+    }
+    urltable_t *table = mem_calloc(1, sizeof(urltable_t));
+    if (table == NULL) {
+        munmap(mapped, len);
+        return NULL;
+    }
+    table->mapped = file;
+    table->mappedLen = len;
+    table->table = file + HEADER;
+    table->strings = (const char *) file + HEADER + tableLen;
+    table->blobLen = len - HEADER - tableLen;
+    table->end = end;
+    return table;
+}
+
+/* see urltable.h for more information */
+const char *urltableGet(const urltable_t *table, const int docID) {
+    if (table == NULL || docID < 1 || docID >= table->end) {
+        return NULL;
+    }
+    if (table->mapped == NULL) {    // a table being built
+        return table->offsets[docID] == (docID + 1 < table->end ? table->offsets[docID + 1] : table->blobLen)
+                    ? NULL : table->blob + table->offsets[docID];
+    }
+    uint32_t start = getLE32(table->table + (size_t) docID * 4);
+    uint32_t stop = getLE32(table->table + (size_t) (docID + 1) * 4);
+    if (start >= stop || stop > table->blobLen) {   // no url, or a corrupt offset
+        return NULL;
+    }
+    return table->strings + start;
+}
+
+/* see urltable.h for more information */
+int urltableEnd(const urltable_t *table) {
+    return table == NULL ? 0 : table->end;
+}
+
+/* see urltable.h for more information */
+void urltableDelete(urltable_t *table) {
+    if (table == NULL) {
+        return;
+    }
+    if (table->mapped != NULL) munmap((void *) table->mapped, table->mappedLen);
+    free(table->offsets);
+    free(table->blob);
+    mem_free(table);
+}
+
+/* function to write a 4 byte little endian integer */
+static void putLE32(unsigned char *buf, const uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        buf[i] = value >> (8 * i);
+    }
+}
+
+/* function to read a 4 byte little endian integer */
+static uint32_t getLE32(const unsigned char *buf) {
+    return buf[0] | buf[1] << 8 | buf[2] << 16 | (uint32_t) buf[3] << 24;
+}
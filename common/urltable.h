@@ -0,0 +1,87 @@
+/**
+ * @file urltable.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief urltable provides a docID -> url table saved as one file (offsets and a string blob) that is mapped
+ *        once, so finding the url of a document is a memory lookup
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __URL_TABLE_H_
+#define __URL_TABLE_H_
+#include <stdbool.h>
+#include <stddef.h>
+
+#define UrltableMagic "TSEURLS1"    // first 8 bytes of a table file
+#define UrltableSuffix ".urls"      // the indexer writes the table of an index file to its name with this added
+
+/**
+ * @brief opaque type holding a table being built, or a table file mapped into memory
+ *
+ */
+typedef struct urltable urltable_t;
+
+/**
+ * @brief function to start a new, empty table
+ *
+ * @return urltable_t* table or NULL on failure
+ */
+urltable_t *urltableNew(void);
+
+/**
+ * @brief function to add the url of a document to a table being built
+ *
+ * @param table table made by urltableNew
+ * @param docID id of the document; ids must be added in increasing order, and ids skipped have no url
+ * @param url url (need not be '\0' terminated)
+ * @param len length of url
+ * @return true if the url was added
+ */
+bool urltableAdd(urltable_t *table, const int docID, const char *url, const size_t len);
+
+/**
+ * @brief function to write a table to a file
+ *
+ * @param table table
+ * @param fn file to write
+ * @return true if the file was written
+ * do
+ *  - write UrltableMagic and the number of ids, then an offset per id (and one past the last), then the urls,
+ *    each followed by a '\0', all integers 4 bytes little endian
+ */
+bool urltableSave(const urltable_t *table, const char *fn);
+
+/**
+ * @brief function to map a table file written by urltableSave
+ *
+ * @param fn file to map
+ * @return urltable_t* table, or NULL if the file does not exist or is not a table
+ */
+urltable_t *urltableLoad(const char *fn);
+
+/**
+ * @brief function to get the url of a document
+ *
+ * @param table table
+ * @param docID id of the document
+ * @return const char* url ('\0' terminated, owned by the table), or NULL if the document has none
+ */
+const char *urltableGet(const urltable_t *table, const int docID);
+
+/**
+ * @brief function to get one more than the largest docID in a table
+ *
+ */
+int urltableEnd(const urltable_t *table);
+
+/**
+ * @brief function to delete a table, unmapping its file
+ *
+ * @param table table (may be NULL)
+ */
+void urltableDelete(urltable_t *table);
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file wordscan.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in wordscan.h (word extraction without copies of the html)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "wordscan.h"
+
+// vector kernels are only used by optimized builds: at -O0 the intrinsics are not inlined and lose to the loop
+#if defined(__OPTIMIZE__) && defined(__AVX2__)
+#include <immintrin.h>
+#define ScanLanes 32    // bytes classified at a time
+typedef __m256i lanes_t;
+#define lanesLoad(c) _mm256_loadu_si256((const __m256i *) (c))
+#define lanesStore(c, v) _mm256_storeu_si256((__m256i *) (c), (v))
+#define lanesSet(b) _mm256_set1_epi8((char) (b))
+#define lanesOr(a, b) _mm256_or_si256((a), (b))
+#define lanesAdd(a, b) _mm256_add_epi8((a), (b))
+#define lanesEq(a, b) _mm256_cmpeq_epi8((a), (b))
+#define lanesGt(a, b) _mm256_cmpgt_epi8((a), (b))
+#define lanesMask(v) ((uint32_t) _mm256_movemask_epi8(v))
+#elif defined(__OPTIMIZE__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define ScanLanes 16
+typedef __m128i lanes_t;
+#define lanesLoad(c) _mm_loadu_si128((const __m128i *) (c))
+#define lanesStore(c, v) _mm_storeu_si128((__m128i *) (c), (v))
+#define lanesSet(b) _mm_set1_epi8((char) (b))
+#define lanesOr(a, b) _mm_or_si128((a), (b))
+#define lanesAdd(a, b) _mm_add_epi8((a), (b))
+#define lanesEq(a, b) _mm_cmpeq_epi8((a), (b))
+#define lanesGt(a, b) _mm_cmpgt_epi8((a), (b))
+#define lanesMask(v) ((uint32_t) _mm_movemask_epi8(v))
+#endif
+
+/**
+ * @brief function to tell an ASCII letter, what isalpha accepts in the C locale the indexer runs in
+ *
+ */
+static inline bool isLetter(const unsigned char c);
+
+#ifdef ScanLanes
+/**
+ * @brief function to classify ScanLanes bytes at once into letters, tag openings and other bytes
+ *
+ * @param c first byte; c .. c + ScanLanes - 1 must be readable
+ * @param tags pointer to store a bit per byte, set for each '<'
+ * @param closes pointer to store a bit per byte, set for each '>'
+ * @return uint64_t a bit per byte, set for each letter
+ */
+static inline uint64_t classify(const char *c, uint64_t *tags, uint64_t *closes);
+#endif
+
+/* see wordscan.h for more information */
+bool wordscanNext(const char *html, const size_t len, size_t *pos, word_span_t *word) {
+    if (html == NULL || pos == NULL || word == NULL) {
+        return false;
+    }
+    const char *c = html + *pos, *end = html + len;
+    while (c < end) {
+#ifdef ScanLanes
+        if (end - c >= ScanLanes) {    // the next letter or tag, and the end of the word, from one classification
+            uint64_t tags, closes, letters = classify(c, &tags, &closes);
+            if ((letters | tags) == 0) {
+                c += ScanLanes;
+                continue;
+            }
+            int skip = __builtin_ctzll(letters | tags);
+            if ((tags >> skip & 1) != 0 && (closes >> skip) != 0) {    // a tag closed in the block
+                c += skip + __builtin_ctzll(closes >> skip) + 1;
+                continue;
+            }
+            c += skip;
+            if ((letters >> skip & 1) != 0) {
+                int run = __builtin_ctzll(~(letters >> skip));  // bits past the block are 0 in letters
+                const char *start = c;
+                c += run;
+                if (run == ScanLanes - skip) {  // the word may go on past the block
+                    while (end - c >= ScanLanes) {
+                        letters = classify(c, &tags, &closes);
+                        if (letters != (1ULL << ScanLanes) - 1) {
+                            c += __builtin_ctzll(~letters);
+                            break;
+                        }
+                        c += ScanLanes;
+                    }
+                    for (; c < end && isLetter(*c); c++);   // the last bytes, fewer than a block
+                }
+                if (c - start >= WordMin) {
+                    word->start = start - html;
+                    word->len = c - start;
+                    *pos = c - html;
+                    return true;
+                }
+                continue;
+            }
+        }
+#endif
+        if (*c == '<') {    // skip the <...tag...>
+            c = memchr(c, '>', end - c);
+            if (c == NULL) {    // ran out of html
+                break;
+            }
+            c++;
+            continue;
+        }
+        if (!isLetter(*c)) {
+            c++;
+            continue;
+        }
+        const char *start = c;
+        for (; c < end && isLetter(*c); c++);
+        if (c - start >= WordMin) {
+            word->start = start - html;
+            word->len = c - start;
+            *pos = c - html;
+            return true;
+        }
+    }
+    *pos = len;
+    return false;
+}
+
+/* see wordscan.h for more information */
+size_t wordscanLower(const char *html, const word_span_t *word, char *buf, const size_t size) {
+    if (html == NULL || word == NULL || buf == NULL || size == 0) {
+        return 0;
+    }
+    size_t len = word->len < size ? word->len : size - 1;
+    const char *from = html + word->start;
+    size_t i = 0;
+#ifdef ScanLanes
+    for (; i + ScanLanes <= len; i += ScanLanes) {  // a word is all letters: setting bit 5 lower cases them
+        lanesStore(buf + i, lanesOr(lanesLoad(from + i), lanesSet(0x20)));
+    }
+#endif
+    for (; i < len; i++) {
+        buf[i] = from[i] | 0x20;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+/* function to tell an ASCII letter */
+static inline bool isLetter(const unsigned char c) {
+    return (unsigned char) ((c | 0x20) - 'a') < 26;
+}
+
+#ifdef ScanLanes
+/* function to classify ScanLanes bytes at once */
+static inline uint64_t classify(const char *c, uint64_t *tags, uint64_t *closes) {
+    lanes_t bytes = lanesLoad(c);
+    // (byte | 0x20) - 'a' < 26 unsigned, as a signed compare: shift the range down to start at -128
+    lanes_t shifted = lanesAdd(lanesOr(bytes, lanesSet(0x20)), lanesSet(0x80 - 'a'));
+    *tags = lanesMask(lanesEq(bytes, lanesSet('<')));
+    *closes = lanesMask(lanesEq(bytes, lanesSet('>')));
+    return lanesMask(lanesGt(lanesSet(-128 + 26), shifted));
+}
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file wordscan.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief wordscan provides word extraction over a page's html in place: words come back as spans into the html,
+ *        and are only lower cased into a buffer when asked
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __WORD_SCAN_H_
+#define __WORD_SCAN_H_
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef WordMin
+#define WordMin 3 // shorter words are not indexed
+#endif
+
+/**
+ * @brief a word found in a page: a run of letters outside any tag
+ *
+ */
+typedef struct wordSpan {
+    size_t start;   // offset of the word in the html
+    size_t len;     // letters in the word (WordMin or more)
+} word_span_t;
+
+/**
+ * @brief function to find the next word in html, reading it once and changing nothing
+ *
+ * @param html html of the page (need not be '\0' terminated)
+ * @param len length of html
+ * @param pos offset to scan from (0 on the first call); moved past the word found
+ * @param word pointer to store the span of the word
+ * @return true if a word was found
+ * @return false once there are no more words (or any argument is NULL)
+ * do
+ *  - skip "<...>" tags, and stop at a '<' that is never closed
+ *  - find the next run of isalpha letters of WordMin or more, the same words webpage_getNextWord gives that the
+ *    indexer keeps
+ */
+bool wordscanNext(const char *html, const size_t len, size_t *pos, word_span_t *word);
+
+/**
+ * @brief function to copy a word to a buffer in lower case, as normalizeWord would leave it
+ *
+ * @param html html of the page
+ * @param word span from wordscanNext
+ * @param buf buffer to write the word to; word->len + 1 bytes hold all of it
+ * @param size size of buf
+ * @return size_t letters written (with a '\0' after them): all of the word, or its first size - 1 letters if
+ *         buf is smaller; 0 if size is 0 or any argument is NULL
+ */
+size_t wordscanLower(const char *html, const word_span_t *word, char *buf, const size_t size);
+
+#endif
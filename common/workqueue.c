@@ -0,0 +1,119 @@
+/**
+ * @file workqueue.c
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief implements items defined in workqueue.h (a bounded, blocking FIFO shared between threads)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "workqueue.h"
+#include "mem.h"
+
+struct workqueue {
+    void **items;           // ring buffer of capacity items
+    int capacity;           // size of items
+    int head;               // index of the oldest item
+    int count;              // items in the queue
+    bool closed;            // no more items will be added
+    pthread_mutex_t lock;   // guards the fields above
+    pthread_cond_t notFull;     // signalled when an item is taken or the queue is closed
+    pthread_cond_t notEmpty;    // signalled when an item is added or the queue is closed
+};
+
+/* function to make a new, empty queue */
+/* see workqueue.h for more information */
+workqueue_t *workqueueNew(const int capacity) {
+    if (capacity < 1) {     // validate arguments
+        return NULL;
+    }
+    workqueue_t *queue = mem_calloc(1, sizeof(workqueue_t));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = mem_calloc(capacity, sizeof(void *));
+    if (queue->items == NULL) {
+        mem_free(queue);
+        return NULL;
+    }
+    queue->capacity = capacity;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->notFull, NULL);
+    pthread_cond_init(&queue->notEmpty, NULL);
+    return queue;
+}
+
+/* function to add an item at the tail of the queue, waiting while the queue is full */
+/* see workqueue.h for more information */
+bool workqueuePut(workqueue_t *queue, void *item) {
+    if (queue == NULL || item == NULL) {    // validate arguments
+        return false;
+    }
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->capacity && !queue->closed) {
+        pthread_cond_wait(&queue->notFull, &queue->lock);
+    }
+    if (queue->closed) {
+        pthread_mutex_unlock(&queue->lock);
+        return false;
+    }
+    queue->items[(queue->head + queue->count++) % queue->capacity] = item;
+    pthread_cond_signal(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+/* function to remove the item at the head of the queue, waiting while the queue is empty */
+/* see workqueue.h for more information */
+void *workqueueTake(workqueue_t *queue) {
+    if (queue == NULL) {    // validate arguments
+        return NULL;
+    }
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed) {
+        pthread_cond_wait(&queue->notEmpty, &queue->lock);
+    }
+    void *item = NULL;
+    if (queue->count > 0) {     // a closed queue still hands out what it holds
+        item = queue->items[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        pthread_cond_signal(&queue->notFull);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return item;
+}
+
+/* function to close the queue */
+/* see workqueue.h for more information */
+void workqueueClose(workqueue_t *queue) {
+    if (queue == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->notFull);
+    pthread_cond_broadcast(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/* function to delete a queue */
+/* see workqueue.h for more information */
+void workqueueDelete(workqueue_t *queue, void (*itemdelete)(void *item)) {
+    if (queue == NULL) {
+        return;
+    }
+    for (int i = 0; i < queue->count && itemdelete != NULL; i++) {
+        itemdelete(queue->items[(queue->head + i) % queue->capacity]);
+    }
+    pthread_cond_destroy(&queue->notEmpty);
+    pthread_cond_destroy(&queue->notFull);
+    pthread_mutex_destroy(&queue->lock);
+    mem_free(queue->items);
+    mem_free(queue);
+}
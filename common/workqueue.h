@@ -0,0 +1,63 @@
+/**
+ * @file workqueue.h
+ * @author Rehoboth Okorie (www.rehoboth.link)
+ * @brief workqueue provides a bounded, blocking FIFO of items handed from one group of threads to another
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef __WORK_QUEUE_H_
+#define __WORK_QUEUE_H_
+#include <stdbool.h>
+
+/**
+ * @brief opaque type holding the items, their lock and the conditions producers and consumers wait on
+ *
+ */
+typedef struct workqueue workqueue_t;
+
+/**
+ * @brief function to make a new, empty queue; safe to share between threads
+ *
+ * @param capacity number of items the queue holds before workqueuePut blocks
+ * @return workqueue_t* new queue or NULL on failure
+ */
+workqueue_t *workqueueNew(const int capacity);
+
+/**
+ * @brief function to add an item at the tail of the queue, waiting while the queue is full
+ *
+ * @param queue queue
+ * @param item item to add (not NULL)
+ * @return true if the item was added
+ * @return false if an argument is invalid or the queue has been closed (the caller keeps the item)
+ */
+bool workqueuePut(workqueue_t *queue, void *item);
+
+/**
+ * @brief function to remove the item at the head of the queue, waiting while the queue is empty
+ *
+ * @param queue queue
+ * @return void* item (the caller now owns it) or NULL once the queue is closed and empty
+ */
+void *workqueueTake(workqueue_t *queue);
+
+/**
+ * @brief function to close the queue: waiting producers fail and consumers drain what is left, then get NULL
+ *
+ * @param queue queue
+ */
+void workqueueClose(workqueue_t *queue);
+
+/**
+ * @brief function to delete a queue; call once no thread uses it
+ *
+ * @param queue queue to delete
+ * @param itemdelete function called on every item still in the queue (may be NULL)
+ */
+void workqueueDelete(workqueue_t *queue, void (*itemdelete)(void *item));
+
+#endif
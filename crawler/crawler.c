@@ -3,53 +3,187 @@
                 retrieves webpages starting from a "seed" URL.
  *  
  * Rehoboth Okorie, Feb 3 2022
- * Usage: ./crawler <seedURL> <pageDirectory> <maxDepth>
+ * Usage: ./crawler <seedURL> <pageDirectory> <maxDepth> [-t threads] [-s parseWorkers] [-w saveWorkers] [-p perHostLimit] [-d perHostDelayMs] [-r host:limit:delayMs] [-o bfs|score] [-m frontierWindow] [-e inFlight] [-k pipelineDepth] [-c checkpointPages] [--resume] [--recrawl] [-a host[/prefix]] [-n nearDistance] [--packed] [--compress] [--connect address:port] [--stats]
  */
 
 #ifndef CrawlerCoeff
-#define CrawlerCoeff 500 // alter this in compilation (using D flag) to improve table efficiency of hashtable depending on expected url density per page
+#define CrawlerCoeff 500 // alter this in compilation (using D flag) to presize the seen url set for the number of urls expected
 #endif
 
+#ifndef HostLimit
+#define HostLimit 4 // default number of fetches allowed in flight to a single host at once
+#endif
+
+#ifndef HostDelay
+#define HostDelay 100 // default milliseconds between the starts of two fetches to a single host
+#endif
+
+#ifndef MaxPolicies
+#define MaxPolicies 32 // upper bound on per-host policies given with -r
+#endif
+
+#ifndef MaxAllowed
+#define MaxAllowed 32 // upper bound on hosts (or host/prefix entries) given with -a
+#endif
+
+#ifndef FrontierWindow
+#define FrontierWindow 65536 // default number of queued pages kept in memory; the rest spill to pageDirectory
+#endif
+
+#ifndef MaxThreads
+#define MaxThreads 64 // upper bound on fetch workers
+#endif
+
+#ifndef MaxPipeline
+#define MaxPipeline 64 // upper bound on requests pipelined over one connection
+#endif
+
+#ifndef StageQueue
+#define StageQueue 256 // pages queued between two stages before the stage feeding them waits
+#endif
+
+#ifndef CheckpointEvery
+#define CheckpointEvery 1000 // default number of saved pages between two checkpoints of the crawl
+#endif
+
+
+#define _POSIX_C_SOURCE 200809L     // truncate
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "webpage.h"
-#include "bag.h"
 #include "hashtable.h"
+#include "urlset.h"
 #include "mem.h"
 #include "pagedir.h"
+#include "http.h"
+#include "evfetch.h"
+#include "hostsched.h"
+#include "frontier.h"
+#include "workqueue.h"
+#include "fetchstats.h"
+#include "allowlist.h"
+#include "linkscan.h"
+#include "simhash.h"
+#include "pagestore.h"
+
+/**
+ * @brief options given to the crawler after the three required arguments
+ *
+ */
+typedef struct crawlOpts {
+    int threads;    // number of fetch workers
+    int parsers;    // number of parse (link extract) workers
+    int savers;     // number of save workers
+    int hostLimit;  // fetches allowed in flight to one host at once
+    long delayMs;   // milliseconds between the starts of two fetches to one host
+    const char *policy[MaxPolicies];    // host:limit:delayMs policies overriding the two above
+    int policies;   // number of policies
+    const char *allow[MaxAllowed];  // host or host/prefix entries links may lead to (-a); the cs50tse prefix if none
+    int allows;     // number of entries
+    int nearDistance;   // skip pages whose SimHash is within this many bits of a saved page's (-n), or -1
+    bool scored;    // within a depth, fetch pages with a higher link score first (-o score)
+    int window;     // queued pages kept in memory before the frontier spills to disk
+    int inFlight;   // if > 0, fetch with the event driven fetcher keeping this many requests in flight
+    int pipeline;   // requests a worker pipelines over one keep-alive connection
+    int checkpointEvery;    // saved pages between two checkpoints (0 turns checkpointing off)
+    bool resume;    // continue from the checkpoint in pageDirectory instead of the seed
+    bool recrawl;   // refresh the pages of an earlier crawl in pageDirectory with conditional requests
+    bool packed;    // save pages to the packed store (.pages and .pageindex) instead of one file each
+    bool compress;  // save the html of every page compressed (lz in common)
+    const char *connectTo;  // address:port every fetch goes to instead of the host of the url (bench/tseserver), or NULL
+    bool stats;     // print pages/s, bytes/s and fetch latency once the crawl ends
+} crawl_opts_t;
+
+/**
+ * @brief a page saved by an earlier crawl of the pageDirectory (--recrawl)
+ *
+ */
+typedef struct knownDoc {
+    int docID;                      // file id the page is saved under; kept when the page is refreshed
+    http_validators_t validators;   // validators of the saved copy; handed to the fetch of the page
+} known_doc_t;
+
+/**
+ * @brief a page on its way through the stages of the crawl: fetch, then parse, then save
+ *
+ */
+typedef struct crawlItem {
+    webpage_t *page;                // fetched page, the saved copy read back after a 304, or NULL
+    http_validators_t validators;   // validators of the response
+    int depth;                      // depth the page was handed out at
+    int pageId;                     // file id to save the page under, or 0 if there is nothing to save
+    bool fresh;                     // true if the page came with a 200, so its validators are saved with it
+} crawl_item_t;
+
+/**
+ * @brief state shared by the workers of every stage; every field below lock is guarded by it
+ *
+ */
+typedef struct crawlState {
+    const char *pageDirectory;  // directory to save webpage files
+    int maxDepth;               // maximum depth to reach in crawling
+    allowlist_t *allowed;       // hosts (and path prefixes) links are followed to; read only
+    hostsched_t *sched;         // per-host politeness: fetches in flight and delay between fetches
+    int pipeline;               // requests a worker pipelines over one keep-alive connection
+    hashtable_t *known;         // url -> known_doc_t of the pages saved by an earlier crawl, or NULL; read only
+    pagestore_t *store;         // packed page directory (--packed), or NULL for one file per page; locks itself
+    bool compress;              // save the html of every page compressed (--compress)
+    workqueue_t *toParse;       // crawl_item_t fetched, waiting to be parsed
+    workqueue_t *toSave;        // crawl_item_t parsed, waiting to be saved
+    pthread_mutex_t lock;       // guards the fields below
+    simset_t *nearSeen;         // SimHash fingerprints of the saved pages (-n), or NULL
+    FILE *nearLog;              // .neardup: "docID url" of each near-duplicate skipped, docID being the saved page
+    pthread_cond_t changed;     // signalled when pages are queued, a depth is scanned or the stages go idle
+    frontier_t *pagesToCrawl;   // pages waiting to be fetched, shallowest depth first
+    int *holding;               // pages handed out and not yet scanned, by depth (maxDepth + 1 entries)
+    urlset_t *pagesSeen;        // fingerprints of the urls that have been queued
+    int active;                 // pages handed out and not yet saved (or dropped)
+    int pageId;                 // id to give the next saved page
+    int handled;                // pages saved, or found not modified, so far
+    int checkpointEvery;        // saved pages between two checkpoints (0 turns checkpointing off)
+    int nextCheckpoint;         // value of handled at which the next checkpoint is due
+    bool pausing;               // a checkpoint is due: no page is handed out until it is written
+} crawl_state_t;
 
 /**
  * @brief helper function to parse args from main into variables
  * 
+ * @param argc number of arguments from main
  * @param args unparsed arguments from main
  * @param seedUrl  seed/first url to star crawling from
  * @param pageDirectory name of directory to save webpage files
  * @param maxDepth maximum depth to reach in crawling
+ * @param opts optional arguments (-t threads, -s parseWorkers, -w saveWorkers, -p perHostLimit, -d perHostDelayMs, -r host:limit:delayMs, -a host[/prefix], -n nearDistance, -o bfs|score, -m frontierWindow, -e inFlight, -k pipelineDepth, -c checkpointPages, --resume, --recrawl, --packed, --compress, --connect address:port, --stats)
  * @return int return 0 if not error -1 if errors
  * do
- *  - nothing id any of args, seedUrl, pageDirectory is NULL or maxDepth < 0
+ *  - nothing id any of args, seedUrl, pageDirectory, opts is NULL or maxDepth < 0
  *  - parse the arguments int args into the variables
  */
-static int parseArgs(char const *args[], char **seedUrl, char **pageDirectory, int *maxDepth);
+static int parseArgs(const int argc, char const *args[], char **seedUrl, char **pageDirectory, int *maxDepth,
+                                                                crawl_opts_t *opts);
 
 /**
  * @brief helper function to initialize required data structures
  * 
  * @param page webpage_t struct
- * @param pagesToCrawl bag_t struct containing pages to crawl
- * @param pagesSeen hashtable_t struct containing seen urls
+ * @param pagesToCrawl frontier_t struct containing pages to crawl
+ * @param pagesSeen urlset_t struct containing seen urls
  * @param seedUrl seed/first url to star crawling from
  * @param maxDepth maximum depth to reach in crawling
+ * @param scored true to order the frontier by link score within a depth
  * @return int return 0 if not error -1 if errors 
  * do 
  *  - nothing if any of page, pagesToCrawl, pagesSeen, seedUrlis NULL or maxDepth < 0
  *  - initialize the pointers to required structs
  */
-static int initStructures(webpage_t **page, bag_t **pagesToCrawl,  hashtable_t **pagesSeen, 
-                                                                const char *seedUrl, const int maxDepth);
+static int initStructures(webpage_t **page, frontier_t **pagesToCrawl,  urlset_t **pagesSeen, 
+                                                                const char *seedUrl, const int maxDepth, const bool scored);
 
 /**
  * @brief function to crawl the web starting from a seed url and continuing down into links within the pages html unitl some max depth
@@ -57,54 +191,306 @@ static int initStructures(webpage_t **page, bag_t **pagesToCrawl,  hashtable_t *
  * @param seedUrl initial url to begin crawling from
  * @param pageDirectory name of directory to save webpage files
  * @param maxDepth 
+ * @param opts optional arguments (number of workers and per host policy)
  * @return int return 0 if not error -1 if errors 
  * do
- *  - nothing if any of seedUrl or pageDirectory is NULL or maxDepth < 0
- *  - normalize seedUrl and initialize structures
- *  - pull a webpage from the bag
- *  - fetch the webpage html using pagefetcher
- *  - save the webpage to file using pageSave
- *  - if not at maxdepth scan the page for new urls using pageScan
+ *  - nothing if any of seedUrl, pageDirectory or opts is NULL or maxDepth < 0
+ *  - allow links to the hosts and prefixes of opts->allow, or to the cs50tse prefix if there are none
+ *  - if opts->nearDistance >= 0, skip saving pages that are near-duplicates of saved ones
+ *  - send every fetch to opts->connectTo if set, and collect fetch statistics if opts->stats is set
+ *  - normalize seedUrl and initialize structures, or load them from the checkpoint if opts->resume is set
+ *  - if opts->recrawl is set, load the pages saved by an earlier crawl so they are fetched conditionally
+ *  - start opts->savers workers running saveWorker and opts->parsers workers running parseWorker
+ *  - start opts->threads workers running crawlWorker and wait for them to finish
+ *  - or, if opts->inFlight > 0, crawl from this thread with crawlEvented
+ *  - close the stage queues and wait for the parse and save workers
+ *  - remove the checkpoint once the crawl has finished, then print the statistics if collected
  */
-static int crawl(const char *seedUrl, const char *pageDirectory, const int maxDepth);
+static int crawl(const char *seedUrl, const char *pageDirectory, const int maxDepth, const crawl_opts_t *opts);
 
 /**
- * @brief function to fetch the html of a webpage into a webpage_t struct
+ * @brief function run by every fetch worker (the network stage)
  * 
- * @param page webpage_t struct
- * @param pageDirectory 
+ * @param arg crawl_state_t shared by the workers
+ * @return void* always NULL
+ * do
+ *  - pull up to state->pipeline webpages of one host and depth from the frontier, waiting while other workers may still add pages
+ *  - wait for a free slot for the host then fetch the webpages over one connection using pageFetch
+ *  - hand each page to the parse stage with pageFetched; never touch the disk or the html
+ *  - return once the frontier is empty and no page is in any stage
+ */
+static void *crawlWorker(void *arg);
+
+/**
+ * @brief function to crawl from a single thread with the event driven fetcher (the network stage)
+ * 
+ * @param state shared crawl state
+ * @param inFlight number of requests to keep in flight
+ * @return int return 0 if not error -1 if errors
+ * do
+ *  - move the pages of the frontier whose depth is final (see levelReady) into the fetcher
+ *  - hand completed pages to the parse stage with pageFetched
+ *  - with nothing in flight, wait for the other stages to queue pages; stop once no page is in any stage
+ *  - stop with -1 if the event loop fails; the crawl then fails and keeps its last checkpoint
+ */
+static int crawlEvented(crawl_state_t *state, const int inFlight);
+
+/**
+ * @brief function run by every parse worker: take fetched pages from state->toParse and pass them to pageParse
+ * 
+ * @param arg crawl_state_t shared by the workers
+ * @return void* always NULL (once the queue is closed and drained)
+ */
+static void *parseWorker(void *arg);
+
+/**
+ * @brief function run by every save worker: take parsed pages from state->toSave and pass them to pagePersist
+ * 
+ * @param arg crawl_state_t shared by the workers
+ * @return void* always NULL (once the queue is closed and drained)
+ */
+static void *saveWorker(void *arg);
+
+/**
+ * @brief function to start the workers of a stage
+ * 
+ * @param threads array of at least n threads
+ * @param n number of workers wanted
+ * @param worker function the workers run
+ * @param state shared crawl state passed to them
+ * @return int number of workers started
+ */
+static int stageStart(pthread_t *threads, const int n, void *(*worker)(void *), crawl_state_t *state);
+
+/**
+ * @brief function to hand a page returned by the fetch to the parse stage
+ * 
+ * @param state shared crawl state
+ * @param page page returned by the fetch; owned by the parse stage from here
+ * @param validators validators of the response; moved into the item, so the caller does not clear them
+ * @param depth depth the page was handed out at
+ * if the page cannot be queued it is dropped as pageParse would drop a failed fetch
+ */
+static void pageFetched(crawl_state_t *state, webpage_t *page, http_validators_t *validators, const int depth);
+
+/**
+ * @brief function to resolve a fetched page, scan it, and pass it on to the save stage
+ * 
+ * @param state shared crawl state
+ * @param item page from the fetch stage; owned by the save stage, or deleted here
+ * do
+ *  - give the page the id of its saved copy if it was saved by an earlier crawl, otherwise claim the next id
+ *  - for a 304, read the saved copy back instead (to be saved again only if the depth of the page changed)
+ *  - scan the page if not at maxDepth, then tell the fetch stage with pageScanned
+ *  - queue the page for saving, or finish it with pageDone if there is nothing to save
+ */
+static void pageParse(crawl_state_t *state, crawl_item_t *item);
+
+/**
+ * @brief function to save a parsed page and its validators, then finish it with pageDone
+ * 
+ * @param state shared crawl state
+ * @param item page from the parse stage; deleted here
+ */
+static void pagePersist(crawl_state_t *state, crawl_item_t *item);
+
+/**
+ * @brief function to delete a crawl_item_t and the page and validators it holds
+ * 
+ * @param arg crawl_item_t to delete
+ */
+static void itemDelete(void *arg);
+
+/**
+ * @brief function to take the next pages to crawl from the shared frontier
+ * 
+ * @param state shared crawl state
+ * @param pages array of state->pipeline page pointers to fill
+ * @return int number of pages taken (all on the host and at the depth of the first) or 0 once the crawl is over
+ */
+static int nextPages(crawl_state_t *state, webpage_t **pages);
+
+/**
+ * @brief function to tell the fetch stage that a page taken with nextPages has been scanned
+ * 
+ * @param state shared crawl state
+ * @param depth depth of the page
+ * once every page of a depth is scanned, pages of the next depth may be handed out
+ */
+static void pageScanned(crawl_state_t *state, const int depth);
+
+/**
+ * @brief function to tell the other workers that a page taken with nextPages has left the last stage
+ * 
+ * @param state shared crawl state
+ * @param handled true if the page was saved or found not modified (counted towards the next checkpoint)
+ * do
+ *  - write the checkpoint if one is due and this was the last page in any stage
+ */
+static void pageDone(crawl_state_t *state, const bool handled);
+
+/**
+ * @brief function to tell whether pages at depth may be handed out; call with the lock held
+ * 
+ * @param state shared crawl state
+ * @param depth depth of the next page in the frontier
+ * @return true if no batch shallower than depth is being handled
+ * a url first seen by a page at depth d could also be linked from a page still being handled at a lower depth,
+ * so holding deeper pages back until that level is done keeps every depth equal to the page's distance from the seed
+ */
+static bool levelReady(crawl_state_t *state, const int depth);
+
+/**
+ * @brief function to write the frontier, the seen set and the next page id to pageDirectory/.checkpoint
+ * 
+ * @param state shared crawl state; call with the lock held and no page being handled
+ * @return int return 0 if not error -1 if errors
+ * do
+ *  - write to .checkpoint.tmp then rename it over .checkpoint, so a crash while writing keeps the last checkpoint
+ *  - pages queued in the frontier are written by url, depth and score; pages already saved are only kept in the seen set
+ *  - record the sizes of .validators and .neardup, whose lines are appended as pages are handled
+ */
+static int checkpointSave(crawl_state_t *state);
+
+/**
+ * @brief function to rebuild the frontier, the seen set and the next page id from pageDirectory/.checkpoint
+ * 
+ * @param state crawl state with pageDirectory and maxDepth set; pagesToCrawl, pagesSeen and pageId are filled in
+ * @param scored true to order the frontier by link score within a depth
+ * @param window queued pages the frontier keeps in memory
+ * @return int return 0 if not error -1 if errors (pagesToCrawl and pagesSeen are then NULL)
+ * do
+ *  - fail if there is no checkpoint or it was written for another maxDepth
+ *  - remove the page files numbered from the checkpointed pageId up to pageDirEnd (or cut them from the packed
+ *    store): they were saved after the checkpoint and their pages are fetched again from the frontier
+ *  - cut .validators and .neardup back to their sizes at the checkpoint, dropping the lines of those pages
+ */
+static int checkpointLoad(crawl_state_t *state, const bool scored, const int window);
+
+/**
+ * @brief functions to get the size of a file appended to in pageDirectory (0 if there is none),
+ *        and to cut it back to an earlier size (true if it is now no larger)
+ *
+ */
+static long logSize(const char *pageDirectory, const char *name);
+static bool logTruncate(const char *pageDirectory, const char *name, const long size);
+
+/**
+ * @brief function to index the pages saved by an earlier crawl of pageDirectory by url (--recrawl)
+ * 
+ * @param state crawl state with pageDirectory set; known is filled in and pageId moved past the saved pages
+ * @return int return 0 if not error -1 if errors
+ * do
+ *  - read the url of every page file up to the largest id (pageDirEnd; pagestoreEnd for a packed store), skipping
+ *    missing ids, and the validators recorded for it by pageDirSaveValidators
+ */
+static int knownLoad(crawl_state_t *state);
+
+/**
+ * @brief function to take the validators of a page saved by an earlier crawl, to send with its fetch
+ * 
+ * @param state shared crawl state
+ * @param url url of the page
+ * @param validators validators to fill in; left empty if the page is not known
+ * a page is fetched once per crawl, so the validators move out of the table with no lock
+ */
+static void knownTake(crawl_state_t *state, const char *url, http_validators_t *validators);
+
+/**
+ * @brief function to set up near-duplicate detection (-n): the fingerprint set and the .neardup log
+ * 
+ * @param state crawl state with pageDirectory and pageId set
+ * @param maxDistance Hamming distance at or under which a page is a near-duplicate
+ * @param fresh true for a new crawl: start a new .neardup; otherwise fingerprint the pages saved so far
+ * @return int return 0 if not error -1 if errors
+ */
+static int nearLoad(crawl_state_t *state, const int maxDistance, const bool fresh);
+
+/**
+ * @brief function to delete a known_doc_t (for hashtable_delete)
+ * 
+ * @param item known_doc_t to delete
+ */
+static void knownDelete(void *item);
+
+/**
+ * @brief function to score a link for a scored frontier: urls with fewer path segments (index pages) score higher
+ * 
+ * @param url normalized url
+ * @return int score
+ */
+static int linkScore(const char *url);
+
+/**
+ * @brief function to wait until the scheduler allows n more fetches to the host of url and claim them
+ * 
+ * @param state shared crawl state
+ * @param url url about to be fetched
+ * @param n number of pages about to be fetched from the host
+ * @return char* hostname claimed (pass to hostRelease) or NULL if url has no host
+ */
+static char *hostAcquire(crawl_state_t *state, const char *url, const int n);
+
+/**
+ * @brief function to release a host claimed with hostAcquire
+ * 
+ * @param state shared crawl state
+ * @param hostname hostname returned by hostAcquire; freed here
+ */
+static void hostRelease(crawl_state_t *state, char *hostname);
+
+/**
+ * @brief function to fetch the html of webpages of one host into webpage_t structs
+ * 
+ * @param pages array of pointers to webpage_t structs; each fetched page is replaced
+ * @param validators array of validators, one per page; pages with validators are fetched conditionally
+ * @param n number of pages
  * @return int return 0 if not error -1 if errors 
  * do 
  *  - nothing is any arg is NULL
- *  - fetch the webpage html
+ *  - fetch the webpages html, pipelined over one keep-alive connection
  */
-static int pageFetch(webpage_t *page, const char *pageDirectory);
+static int pageFetch(webpage_t **pages, http_validators_t *validators, const int n);
 
 /**
  * @brief function to scan/parse a webpage using the webpage_t struct and extract all urls and links in the page
  * 
  * @param page webpage_t struct
- * @param pagesSeen hashtable of seen urls
- * @param pagesToCrawl bag containing pages to crawl
+ * @param state shared crawl state holding the set of seen urls and the frontier of pages to crawl
  * @return int return 0 if not error -1 if errors
  * do 
  *  - nothing if any arg is NULL
- *  - scna the page for new/unseen urls and add the to the bad and hashtable
+ *  - scna the page for new/unseen urls and add the to the frontier and seen set
+ *  - links are read in place with linkscan (the html is not changed, so it is saved as fetched) and resolved
+ *    into a stack buffer; only a url that is allowed and unseen is copied to the heap
  */
-static int pageScan(webpage_t *page, hashtable_t *pagesSeen, bag_t *pagesToCrawl);
+static int pageScan(webpage_t *page, crawl_state_t *state);
 
 /**
  * @brief function to save a webpages url, depth from seed and html into a file identified by pageId
  * 
  * @param page webpage_t struct
 * @param pageDirectory name of directory to save webpage files
+ * @param store packed page store to save into instead (--packed), or NULL
+ * @param compress true to save the html compressed (--compress)
  * @param pageId pageId which will be used as file name
  * @return int return 0 if not error -1 if errors
  * do 
  *  - nothing is page is NULL or pageId < 0
- * - save the page url, depth and html to a file
+ * - save the page url, depth and html to a file, or append them to the store
  */
-static int pageSave(webpage_t *page, const char *pageDirectory, const int pageId);
+static int pageSave(webpage_t *page, const char *pageDirectory, pagestore_t *store, const bool compress,
+                                                                                        const int pageId);
+
+/**
+ * @brief function to load a page saved by this or an earlier crawl of pageDirectory
+ * 
+ * @param state crawl state with pageDirectory and store set
+ * @param page pointer to store the new webpage
+ * @param docID id of the page
+ * @return int 1 on success, as pageDirLoad or pagestoreLoad otherwise
+ */
+static int pageLoad(crawl_state_t *state, webpage_t **page, const int docID);
 
 /**
  * @brief functino to print error pessages only when in DEV or TEST modes
@@ -119,15 +505,16 @@ static void printErrorMessage(const char *message);
 
 int main(int argc, char const *argv[]) {
     if (argc < 4) {
-        printErrorMessage("Usage: ./crawler <seedURL> <pageDirectory> <maxDepth>");
+        printErrorMessage("Usage: ./crawler <seedURL> <pageDirectory> <maxDepth> [-t threads] [-s parseWorkers] [-w saveWorkers] [-p perHostLimit] [-d perHostDelayMs] [-r host:limit:delayMs] [-o bfs|score] [-m frontierWindow] [-e inFlight] [-k pipelineDepth] [-c checkpointPages] [--resume] [--recrawl] [-a host[/prefix]] [-n nearDistance] [--packed] [--compress] [--connect address:port] [--stats]");
         exit(-1);
     }
     char *seedUrl;
     char *pageDirectory;
     int maxDept;
+    crawl_opts_t opts;
     // parse args and exit non-zero if there are any issues
-    if (parseArgs(argv, &seedUrl, &pageDirectory, &maxDept) != 0) {
-        printErrorMessage("Usage: ./crawler <seedURL> <pageDirectory> <maxDepth>");
+    if (parseArgs(argc, argv, &seedUrl, &pageDirectory, &maxDept, &opts) != 0) {
+        printErrorMessage("Usage: ./crawler <seedURL> <pageDirectory> <maxDepth> [-t threads] [-s parseWorkers] [-w saveWorkers] [-p perHostLimit] [-d perHostDelayMs] [-r host:limit:delayMs] [-o bfs|score] [-m frontierWindow] [-e inFlight] [-k pipelineDepth] [-c checkpointPages] [--resume] [--recrawl] [-a host[/prefix]] [-n nearDistance] [--packed] [--compress] [--connect address:port] [--stats]");
         exit(-1);
     }
     // initi dir and exit non-zero if there are any issues 
@@ -136,7 +523,7 @@ int main(int argc, char const *argv[]) {
         exit(-1);
     }
     // crawl from seed url and exit non-zero if there are any issues 
-    if (crawl(seedUrl, pageDirectory, maxDept) != 0) {
+    if (crawl(seedUrl, pageDirectory, maxDept, &opts) != 0) {
         printErrorMessage("main: crawler failed to run successfuly.");
         exit(-1);
     }
@@ -146,8 +533,9 @@ int main(int argc, char const *argv[]) {
 
 /* helper function to parse args from main into variables */
 // use double pointer to refer to original pointer values even in function
-static int parseArgs(char const *args[], char **seedUrl, char **pageDirectory, int *maxDepth) {
-    if (args == NULL || seedUrl == NULL || pageDirectory == NULL || maxDepth == NULL) { // ensure args are valid
+static int parseArgs(const int argc, char const *args[], char **seedUrl, char **pageDirectory, int *maxDepth,
+                                                                crawl_opts_t *opts) {
+    if (args == NULL || seedUrl == NULL || pageDirectory == NULL || maxDepth == NULL || opts == NULL) { // ensure args are valid
         printErrorMessage("parseArgs: Invalid Args.");
         return -1;
     }
@@ -177,13 +565,88 @@ static int parseArgs(char const *args[], char **seedUrl, char **pageDirectory, i
         }
     }
     *maxDepth = strtol(args[3], NULL, 10);
+
+    opts->threads = 1;
+    opts->parsers = 1;
+    opts->savers = 1;
+    opts->hostLimit = HostLimit;
+    opts->delayMs = HostDelay;
+    opts->policies = 0;
+    opts->allows = 0;
+    opts->nearDistance = -1;
+    opts->scored = false;
+    opts->window = FrontierWindow;
+    opts->inFlight = 0;
+    opts->pipeline = 1;
+    opts->checkpointEvery = CheckpointEvery;
+    opts->resume = false;
+    opts->recrawl = false;
+    opts->packed = false;
+    opts->compress = false;
+    opts->connectTo = NULL;
+    opts->stats = false;
+    for (int i = 4; i < argc; i += 2) {    // optional arguments come in flag/value pairs
+        int value = (i + 1 < argc) ? (int) strtol(args[i + 1], NULL, 10) : 0;
+        if (strcmp(args[i], "--resume") == 0) {
+            opts->resume = true;
+            i--;    // a bare flag: there is no value to skip
+        } else if (strcmp(args[i], "--recrawl") == 0) {
+            opts->recrawl = true;
+            i--;
+        } else if (strcmp(args[i], "--packed") == 0) {
+            opts->packed = true;
+            i--;
+        } else if (strcmp(args[i], "--compress") == 0) {
+            opts->compress = true;
+            i--;
+        } else if (strcmp(args[i], "--stats") == 0) {
+            opts->stats = true;
+            i--;
+        } else if (strcmp(args[i], "--connect") == 0 && i + 1 < argc && strchr(args[i + 1], ':') != NULL) {
+            opts->connectTo = args[i + 1];   // checked in full when the crawl starts
+        } else if (strcmp(args[i], "-t") == 0 && value > 0 && value <= MaxThreads) {
+            opts->threads = value;
+        } else if (strcmp(args[i], "-s") == 0 && value > 0 && value <= MaxThreads) {
+            opts->parsers = value;
+        } else if (strcmp(args[i], "-w") == 0 && value > 0 && value <= MaxThreads) {
+            opts->savers = value;
+        } else if (strcmp(args[i], "-p") == 0 && value > 0) {
+            opts->hostLimit = value;
+        } else if (strcmp(args[i], "-d") == 0 && i + 1 < argc && isdigit(args[i + 1][0])) {
+            opts->delayMs = strtol(args[i + 1], NULL, 10);
+        } else if (strcmp(args[i], "-r") == 0 && i + 1 < argc && opts->policies < MaxPolicies
+                                                                && strchr(args[i + 1], ':') != NULL) {
+            opts->policy[opts->policies++] = args[i + 1];   // checked in full once the scheduler exists
+        } else if (strcmp(args[i], "-a") == 0 && i + 1 < argc && opts->allows < MaxAllowed) {
+            opts->allow[opts->allows++] = args[i + 1];  // checked in full when the allowlist is built
+        } else if (strcmp(args[i], "-n") == 0 && i + 1 < argc && isdigit(args[i + 1][0])
+                                                                && value <= SimhashMaxDistance) {
+            opts->nearDistance = value;
+        } else if (strcmp(args[i], "-o") == 0 && i + 1 < argc
+                                && (strcmp(args[i + 1], "bfs") == 0 || strcmp(args[i + 1], "score") == 0)) {
+            opts->scored = strcmp(args[i + 1], "score") == 0;
+        } else if (strcmp(args[i], "-m") == 0 && value > 0) {
+            opts->window = value;
+        } else if (strcmp(args[i], "-e") == 0 && value > 0) {
+            opts->inFlight = value;
+        } else if (strcmp(args[i], "-k") == 0 && value > 0 && value <= MaxPipeline) {
+            opts->pipeline = value;
+        } else if (strcmp(args[i], "-c") == 0 && i + 1 < argc && isdigit(args[i + 1][0])) {
+            opts->checkpointEvery = value;
+        } else {
+            printErrorMessage("parseArgs: invalid option.");
+            mem_free(*seedUrl);
+            mem_free(*pageDirectory);
+            return -1;
+        }
+    }
     return 0;
 }
 
 /* helper function to initialize required data structures */
 // use double pointer to refer to original pointer values even in function
-static int initStructures(webpage_t **page, bag_t **pagesToCrawl,  hashtable_t **pagesSeen,    
-                                                                const char *seedUrl, const int maxDepth) {
+static int initStructures(webpage_t **page, frontier_t **pagesToCrawl,  urlset_t **pagesSeen,    
+                                                                const char *seedUrl, const int maxDepth, const bool scored) {
     if (page == NULL || pagesToCrawl == NULL || pagesSeen == NULL || seedUrl == NULL || maxDepth < 0) { // ensure args are valid
         printErrorMessage("initStructures: Invalid args.");
         return -1;
@@ -194,30 +657,29 @@ static int initStructures(webpage_t **page, bag_t **pagesToCrawl,  hashtable_t *
         printErrorMessage("initStructures: webpage new failed.");
         return -1;
     }
-    *pagesToCrawl = bag_new();
-    if (*pagesToCrawl == NULL) { // ensure bag_new was successful
-        printErrorMessage("initStructures: bag new failed.");
+    *pagesToCrawl = frontierNew(scored);
+    if (*pagesToCrawl == NULL) { // ensure frontierNew was successful
+        printErrorMessage("initStructures: frontier new failed.");
         return -1;
     }
-    bag_insert(*pagesToCrawl, *page); // inser webpage into page
+    frontierPush(*pagesToCrawl, *page, 0); // insert webpage into frontier
     
-    *pagesSeen = hashtable_new(CrawlerCoeff);
-    if (*pagesSeen == NULL) {  // ensure hashtable_new was successful
-        printErrorMessage("initStructures: hashtable new failed.");
+    *pagesSeen = urlsetNew(CrawlerCoeff);
+    if (*pagesSeen == NULL) {  // ensure urlsetNew was successful
+        printErrorMessage("initStructures: urlset new failed.");
         return -1;
     }
     return 0;
 }
 
 /* function to crawl the web starting from a seed url and continuing down into links within the pages html unitl some max depth */
-static int crawl(const char *seedUrl, const char *pageDirectory, const int maxDepth) {
-    if (seedUrl == NULL || pageDirectory == NULL || maxDepth < 0) { // ensure args are valid
+static int crawl(const char *seedUrl, const char *pageDirectory, const int maxDepth, const crawl_opts_t *opts) {
+    if (seedUrl == NULL || pageDirectory == NULL || maxDepth < 0 || opts == NULL) { // ensure args are valid
         printErrorMessage("crawl: Invalid args.");
         return -1;
     }
     webpage_t *page;
-    bag_t *pagesToCrawl;
-    hashtable_t *pagesSeen;
+    crawl_state_t state;
     char *url = normalizeURL(seedUrl);  // normalize url
     if (url == NULL) { // ensure normalizeURL was successful
         printErrorMessage("crawl: normalize url failed.");
@@ -225,55 +687,664 @@ static int crawl(const char *seedUrl, const char *pageDirectory, const int maxDe
         mem_free((char *) pageDirectory);
         return -1;
     }
-    if (!isInternalURL(url)) { // ensure url is an internal url
-        printErrorMessage("crawl: external url.");
+    state.allowed = allowlistNew();
+    bool allowing = state.allowed != NULL;
+    for (int i = 0; allowing && i < opts->allows; i++) {
+        allowing = allowlistAdd(state.allowed, opts->allow[i]);
+    }
+    if (allowing && opts->allows == 0) {    // only the cs50tse pages, as isInternalURL
+        allowing = allowlistAdd(state.allowed, INTERNAL_PREFIX);
+    }
+    if (!allowing || !allowlistMatch(state.allowed, url)) { // ensure url is an internal url
+        printErrorMessage(allowing ? "crawl: external url." : "crawl: invalid -a host[/prefix].");
         mem_free((char *) seedUrl);
         mem_free((char *) pageDirectory);
         mem_free(url);
+        allowlistDelete(state.allowed);
         return -1;
     }
-    if (initStructures(&page, &pagesToCrawl, &pagesSeen, url, maxDepth) != 0) {
+    if (opts->connectTo != NULL && !httpConnectTo(opts->connectTo)) {
+        printErrorMessage("crawl: invalid --connect address:port.");
         mem_free((char *) seedUrl);
         mem_free((char *) pageDirectory);
         mem_free(url);
-        return -1;    // enure required structures are initializzed
-    }
-    hashtable_insert(pagesSeen, seedUrl, ""); // insert seedUrl into hashtable
-    hashtable_insert(pagesSeen, url, ""); // insert seedUrl into hashtable
-    int pageId = 1;
-    while ((page = bag_extract(pagesToCrawl)) != NULL) {    // stop when bag is empty
-        if (pageFetch(page, pageDirectory) != 0) {    // ensure webpage html is properly fetched
-            webpage_delete(page); // delete webpage
-            continue;
+        allowlistDelete(state.allowed);
+        return -1;
+    }
+    long startedAt = fetchstatsClock();
+    if (opts->stats) {
+        fetchstatsEnable();
+    }
+    state.pageDirectory = pageDirectory;
+    state.maxDepth = maxDepth;
+    state.pageId = 1;
+    state.store = NULL;
+    state.compress = opts->compress;
+    bool earlier = opts->resume || opts->recrawl;   // a crawl of pageDirectory saved before goes on in the same form
+    if (opts->packed || (earlier && pagestoreExists(pageDirectory))) {
+        state.store = pagestoreOpen(pageDirectory, earlier ? PAGESTORE_APPEND : PAGESTORE_CREATE);
+        if (state.store == NULL) {
+            printErrorMessage("crawl: could not open the packed page store.");
+            mem_free((char *) seedUrl);
+            mem_free((char *) pageDirectory);
+            mem_free(url);
+            allowlistDelete(state.allowed);
+            return -1;
         }
-        if (pageSave(page, pageDirectory, pageId) != 0) {  // ensure webpage is saved to file
-            webpage_delete(page); // delete webpage
+    }
+    bool resumed = opts->resume && checkpointLoad(&state, opts->scored, opts->window) == 0;
+    if (resumed) {   // continue the last crawl
+        mem_free(url);
+    } else {
+        if (opts->resume) {
+            printErrorMessage("crawl: no usable checkpoint, crawling from the seed.");
+        }
+        // a new crawl starts an empty store, as --packed without --resume does; --recrawl keeps the pages it refreshes
+        if (!opts->recrawl && state.store != NULL && !pagestoreTruncate(state.store, 1)) {
+            printErrorMessage("crawl: could not empty the packed page store.");
+            mem_free((char *) seedUrl);
+            mem_free((char *) pageDirectory);
+            mem_free(url);
+            allowlistDelete(state.allowed);
+            pagestoreClose(state.store);
+            return -1;
+        }
+        if (initStructures(&page, &state.pagesToCrawl, &state.pagesSeen, url, maxDepth, opts->scored) != 0) {
+            mem_free((char *) seedUrl);
+            mem_free((char *) pageDirectory);
+            mem_free(url);
+            allowlistDelete(state.allowed);
+            pagestoreClose(state.store);
+            return -1;    // enure required structures are initializzed
+        }
+        urlsetInsert(state.pagesSeen, url); // insert normalized seedUrl into seen set
+        frontierSpill(state.pagesToCrawl, pageDirectory, opts->window); // bound the pages queued in memory
+        if (!opts->recrawl) {   // a new crawl: validators recorded for files it overwrites no longer apply
+            char validators[strlen(pageDirectory) + 32];
+            sprintf(validators, "%s/.validators", pageDirectory);
+            remove(validators);
+        }
+    }
+    state.known = NULL;
+    if (opts->recrawl && knownLoad(&state) != 0) {
+        printErrorMessage("crawl: could not load the pages of the earlier crawl.");
+    }
+    state.nearSeen = NULL;
+    state.nearLog = NULL;
+    if (opts->nearDistance >= 0 && nearLoad(&state, opts->nearDistance, !resumed && !opts->recrawl) != 0) {
+        printErrorMessage("crawl: near-duplicate detection is off.");
+    }
+    state.sched = hostschedNew(opts->hostLimit, opts->delayMs);
+    state.holding = mem_calloc(maxDepth + 1, sizeof(int));
+    if (state.sched == NULL || state.holding == NULL) { // ensure hostschedNew and calloc were successful
+        printErrorMessage("crawl: hostsched new failed.");
+        mem_free((char *) seedUrl);
+        frontierDelete(state.pagesToCrawl, webpage_delete);
+        urlsetDelete(state.pagesSeen);
+        hostschedDelete(state.sched);
+        mem_free(state.holding);
+        allowlistDelete(state.allowed);
+        simsetDelete(state.nearSeen);
+        if (state.nearLog != NULL) fclose(state.nearLog);
+        pagestoreClose(state.store);
+        return -1;
+    }
+    for (int i = 0; i < opts->policies; i++) {
+        if (!hostschedParsePolicy(state.sched, opts->policy[i])) {  // bad policies are ignored, not fatal
+            printErrorMessage("crawl: invalid host policy.");
+        }
+    }
+    state.pipeline = opts->pipeline;
+    state.active = 0;
+    state.handled = 0;
+    state.checkpointEvery = opts->checkpointEvery;
+    state.nextCheckpoint = opts->checkpointEvery;
+    state.pausing = false;
+    state.toParse = workqueueNew(StageQueue);
+    state.toSave = workqueueNew(StageQueue);
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.changed, NULL);
+
+    // fetch -> parse -> save, each stage with its own workers and a bounded queue in front of the next
+    pthread_t workers[MaxThreads], parsers[MaxThreads], savers[MaxThreads];
+    int nSavers = state.toSave == NULL ? 0 : stageStart(savers, opts->savers, saveWorker, &state);
+    int nParsers = state.toParse == NULL ? 0 : stageStart(parsers, opts->parsers, parseWorker, &state);
+    int started = -1;
+    bool failed = false;
+    if (nSavers == 0 || nParsers == 0) {    // the fetch stage would have nowhere to put its pages
+        printErrorMessage("crawl: could not start the parse and save workers.");
+    } else if (opts->inFlight > 0) {   // one thread, many requests in flight
+        failed = crawlEvented(&state, opts->inFlight) != 0;
+    } else {
+        started = stageStart(workers, opts->threads, crawlWorker, &state);
+        if (started == 0) {   // no worker could be started so fetch on this thread
+            crawlWorker(&state);
+        }
+    }
+    for (int i = 0; i < started; i++) {   // wait for the crawl to finish
+        pthread_join(workers[i], NULL);
+    }
+    workqueueClose(state.toParse);  // every page has left the stages: let the workers return
+    for (int i = 0; i < nParsers; i++) {
+        pthread_join(parsers[i], NULL);
+    }
+    workqueueClose(state.toSave);
+    for (int i = 0; i < nSavers; i++) {
+        pthread_join(savers[i], NULL);
+    }
+    workqueueDelete(state.toParse, itemDelete);
+    workqueueDelete(state.toSave, itemDelete);
+
+    httpCleanup();  // close idle keep-alive connections
+    if (opts->stats) {
+        fetchstatsReport(stdout, (fetchstatsClock() - startedAt) / 1e6);
+    }
+    char checkpoint[strlen(pageDirectory) + 32];
+    sprintf(checkpoint, "%s/.checkpoint", pageDirectory);
+    if (!failed) {
+        remove(checkpoint); // the crawl is complete: there is nothing to resume
+    }
+    pthread_cond_destroy(&state.changed);
+    pthread_mutex_destroy(&state.lock);
+    mem_free((char *) seedUrl);
+    frontierDelete(state.pagesToCrawl, webpage_delete); // delete frontier struct
+    urlsetDelete(state.pagesSeen); // delete seen set
+    hostschedDelete(state.sched); // delete host policies
+    mem_free(state.holding);
+    allowlistDelete(state.allowed);
+    simsetDelete(state.nearSeen);
+    if (state.nearLog != NULL) fclose(state.nearLog);
+    pagestoreClose(state.store);
+    if (state.known != NULL) hashtable_delete(state.known, knownDelete);
+    return failed ? -1 : 0;
+}
+
+/* function run by every fetch worker */
+static void *crawlWorker(void *arg) {
+    crawl_state_t *state = (crawl_state_t *) arg;
+    webpage_t *pages[MaxPipeline];
+    http_validators_t validators[MaxPipeline];
+    int n;
+    while ((n = nextPages(state, pages)) > 0) {    // stop when frontier is empty and no page is being crawled
+        int depth = webpage_getDepth(pages[0]);
+        for (int i = 0; i < n; i++) {
+            knownTake(state, webpage_getURL(pages[i]), &validators[i]);
+        }
+        char *hostname = hostAcquire(state, webpage_getURL(pages[0]), n);
+        pageFetch(pages, validators, n);
+        hostRelease(state, hostname);
+        for (int i = 0; i < n; i++) {   // parsing and saving happen in the later stages
+            pageFetched(state, pages[i], &validators[i], depth);
+        }
+    }
+    return NULL;
+}
+
+/* function to crawl from a single thread with the event driven fetcher */
+static int crawlEvented(crawl_state_t *state, const int inFlight) {
+    evfetch_t *ev = evfetchNew(inFlight, state->sched);
+    if (ev == NULL) {
+        printErrorMessage("crawlEvented: evfetch new failed.");
+        return -1;
+    }
+    webpage_t *page;
+    for (;;) {
+        pthread_mutex_lock(&state->lock);
+        // hand queued pages to the fetcher once their depth is final; its queue is kept short so a checkpoint
+        // only waits on the fetches in flight
+        while (!state->pausing && evfetchPending(ev) < 2 * inFlight && (page = frontierPeek(state->pagesToCrawl)) != NULL
+               && levelReady(state, webpage_getDepth(page))) {
+            frontierPop(state->pagesToCrawl);
+            state->holding[webpage_getDepth(page)]++;
+            state->active++;
+            http_validators_t *validators = mem_calloc(1, sizeof(http_validators_t));
+            knownTake(state, webpage_getURL(page), validators);
+            if (validators == NULL || !evfetchAdd(ev, page, validators)) {
+                state->holding[webpage_getDepth(page)]--;
+                state->active--;
+                httpValidatorsClear(validators);
+                mem_free(validators);
+                webpage_delete(page);
+            }
+        }
+        // with nothing in flight, wait for the other stages to queue pages, finish a depth or write a checkpoint
+        while (evfetchPending(ev) == 0 && (state->pausing
+               || ((page = frontierPeek(state->pagesToCrawl)) == NULL && state->active > 0)
+               || (page != NULL && !levelReady(state, webpage_getDepth(page))))) {
+            pthread_cond_wait(&state->changed, &state->lock);
+        }
+        bool over = evfetchPending(ev) == 0 && frontierPeek(state->pagesToCrawl) == NULL;
+        pthread_mutex_unlock(&state->lock);
+        if (over) {     // frontier and every stage are empty
+            break;
+        }
+        http_validators_t *validators;
+        if ((page = evfetchNext(ev, &validators)) == NULL) {
+            if (evfetchPending(ev) > 0) {   // the event loop failed with requests still pending
+                printErrorMessage("crawlEvented: event loop failed.");
+                evfetchDelete(ev);
+                return -1;
+            }
+            continue;   // nothing was in flight: queue the pages that are ready
+        }
+        if (webpage_getHTML(page) == NULL && !validators->notModified) {    // ensure webpage html is properly fetched
+            printErrorMessage(webpage_getURL(page));
+            printErrorMessage("crawlEvented: webpage fetch failed.");
+        }
+        pageFetched(state, page, validators, webpage_getDepth(page));
+        mem_free(validators);
+    }
+    evfetchDelete(ev);
+    return 0;
+}
+
+/* function run by every parse worker */
+static void *parseWorker(void *arg) {
+    crawl_state_t *state = (crawl_state_t *) arg;
+    crawl_item_t *item;
+    while ((item = workqueueTake(state->toParse)) != NULL) {
+        pageParse(state, item);
+    }
+    return NULL;
+}
+
+/* function run by every save worker */
+static void *saveWorker(void *arg) {
+    crawl_state_t *state = (crawl_state_t *) arg;
+    crawl_item_t *item;
+    while ((item = workqueueTake(state->toSave)) != NULL) {
+        pagePersist(state, item);
+    }
+    return NULL;
+}
+
+/* function to start the workers of a stage */
+static int stageStart(pthread_t *threads, const int n, void *(*worker)(void *), crawl_state_t *state) {
+    int started = 0;
+    for (; started < n; started++) {
+        if (pthread_create(&threads[started], NULL, worker, state) != 0) {
+            printErrorMessage("stageStart: could not start every worker.");
+            break;
+        }
+    }
+    return started;
+}
+
+/* function to hand a page returned by the fetch to the parse stage */
+static void pageFetched(crawl_state_t *state, webpage_t *page, http_validators_t *validators, const int depth) {
+    crawl_item_t *item = mem_calloc(1, sizeof(crawl_item_t));
+    if (item == NULL) {     // drop the page as a failed fetch
+        webpage_delete(page);
+        httpValidatorsClear(validators);
+        pageScanned(state, depth);
+        pageDone(state, false);
+        return;
+    }
+    item->page = page;
+    item->validators = *validators;
+    item->depth = depth;
+    if (!workqueuePut(state->toParse, item)) {  // blocks while the parse stage is behind
+        itemDelete(item);
+        pageScanned(state, depth);
+        pageDone(state, false);
+    }
+}
+
+/* function to resolve a fetched page, scan it, and pass it on to the save stage */
+static void pageParse(crawl_state_t *state, crawl_item_t *item) {
+    known_doc_t *doc = state->known == NULL ? NULL : hashtable_find(state->known, webpage_getURL(item->page));
+    if (item->validators.notModified && doc != NULL) {   // the saved copy is current: read it back instead
+        webpage_t *stored = NULL;
+        if (pageLoad(state, &stored, doc->docID) != 1) {
+            printErrorMessage("pageParse: saved copy could not be read.");
+            stored = NULL;
+        } else if (webpage_getDepth(stored) != item->depth) {   // reached at another depth this time
+            char *url = mem_malloc(strlen(webpage_getURL(stored)) + 1);
+            char *html = mem_malloc(strlen(webpage_getHTML(stored)) + 1);
+            webpage_t *moved = (url == NULL || html == NULL) ? NULL : webpage_new(strcpy(url, webpage_getURL(stored)),
+                                                        item->depth, strcpy(html, webpage_getHTML(stored)));
+            if (moved == NULL) {
+                mem_free(url);
+                mem_free(html);
+            }
+            webpage_delete(stored);
+            stored = moved;
+            item->pageId = doc->docID;  // only the depth line changes
+        }
+        webpage_delete(item->page);
+        item->page = stored;
+    } else if (webpage_getHTML(item->page) != NULL) {    // ensure webpage html is properly fetched
+        bool checked = state->nearSeen != NULL && doc == NULL;  // a refreshed page keeps its file
+        uint64_t fingerprint = checked ? simhashPage(webpage_getHTML(item->page)) : 0;  // hash outside the lock
+        pthread_mutex_lock(&state->lock);
+        int original = checked ? simsetNear(state->nearSeen, fingerprint) : 0;
+        if (original > 0) {    // a near-duplicate: links are followed, but the page is not saved
+            if (state->nearLog != NULL) {   // flushed now, so a crawl stopped early keeps the line
+                fprintf(state->nearLog, "%d %s\n", original, webpage_getURL(item->page));
+                fflush(state->nearLog);
+            }
+        } else {
+            item->pageId = doc != NULL ? doc->docID : state->pageId++;    // a refreshed page keeps its id
+            item->fresh = true;
+            if (checked) simsetAdd(state->nearSeen, fingerprint, item->pageId);
+        }
+        pthread_mutex_unlock(&state->lock);
+    } else {
+        webpage_delete(item->page);
+        item->page = NULL;
+    }
+    if (item->page != NULL && item->depth < state->maxDepth) {
+        pageScan(item->page, state);  // skip if at depth limit
+    }
+    pageScanned(state, item->depth);
+    if (item->page != NULL && item->pageId > 0 && workqueuePut(state->toSave, item)) {
+        return;     // the save stage finishes it
+    }
+    pageDone(state, item->page != NULL);
+    itemDelete(item);
+}
+
+/* function to save a parsed page and its validators, then finish it with pageDone */
+static void pagePersist(crawl_state_t *state, crawl_item_t *item) {
+    // save the webpage to pageDirectory
+    bool saved = pageSave(item->page, state->pageDirectory, state->store, state->compress, item->pageId) == 0;
+    if (saved && item->fresh) {
+        pageDirSaveValidators(state->pageDirectory, item->pageId, &item->validators);
+    }
+    pageDone(state, saved);
+    itemDelete(item);
+}
+
+/* function to delete a crawl_item_t and the page and validators it holds */
+static void itemDelete(void *arg) {
+    crawl_item_t *item = arg;
+    if (item == NULL) {
+        return;
+    }
+    if (item->page != NULL) webpage_delete(item->page); // delete webpage
+    httpValidatorsClear(&item->validators);
+    mem_free(item);
+}
+
+/* function to take the next pages to crawl from the shared frontier */
+static int nextPages(crawl_state_t *state, webpage_t **pages) {
+    pthread_mutex_lock(&state->lock);
+    webpage_t *page = frontierPeek(state->pagesToCrawl);
+    // wait while another worker may still queue pages, or may still find the next page at a lower depth,
+    // or while a checkpoint is due
+    while (state->pausing || (page == NULL && state->active > 0)
+           || (page != NULL && !levelReady(state, webpage_getDepth(page)))) {
+        pthread_cond_wait(&state->changed, &state->lock);
+        page = frontierPeek(state->pagesToCrawl);
+    }
+    if (page == NULL) {   // frontier is empty and no worker holds a page
+        pthread_mutex_unlock(&state->lock);
+        return 0;
+    }
+    int n = 0;
+    pages[n++] = frontierPop(state->pagesToCrawl);
+    int depth = webpage_getDepth(page);
+    // fill the pipeline with the pages that follow at the same depth on the same host
+    const char *url = webpage_getURL(page);
+    const char *hostEnd = strncmp(url, "http://", 7) == 0 ? strchr(url + 7, '/') : NULL;
+    size_t hostLen = hostEnd == NULL ? 0 : hostEnd - url;
+    while (hostLen > 0 && n < state->pipeline && (page = frontierPeek(state->pagesToCrawl)) != NULL
+           && webpage_getDepth(page) == depth && strncmp(webpage_getURL(page), url, hostLen) == 0
+           && webpage_getURL(page)[hostLen] == '/') {
+        pages[n++] = frontierPop(state->pagesToCrawl);
+    }
+    state->active += n;
+    state->holding[depth] += n;
+    pthread_mutex_unlock(&state->lock);
+    return n;
+}
+
+/* function to tell the fetch stage that a page taken with nextPages has been scanned */
+static void pageScanned(crawl_state_t *state, const int depth) {
+    pthread_mutex_lock(&state->lock);
+    if (--state->holding[depth] == 0) { // idle fetchers may now be able to go deeper
+        pthread_cond_broadcast(&state->changed);
+    }
+    pthread_mutex_unlock(&state->lock);
+}
+
+/* function to tell the other workers that a page taken with nextPages has left the last stage */
+static void pageDone(crawl_state_t *state, const bool handled) {
+    pthread_mutex_lock(&state->lock);
+    state->active--;
+    if (handled) {
+        state->handled++;
+    }
+    if (state->checkpointEvery > 0 && state->handled >= state->nextCheckpoint) {
+        state->pausing = true;  // let the stages drain, then checkpoint
+    }
+    if (state->pausing && state->active == 0) { // the last page out writes the checkpoint
+        checkpointSave(state);
+        state->pausing = false;
+        state->nextCheckpoint = state->handled + state->checkpointEvery;
+    }
+    if (state->active == 0) { // idle fetchers may now be able to finish or carry on
+        pthread_cond_broadcast(&state->changed);
+    }
+    pthread_mutex_unlock(&state->lock);
+}
+
+/* function to tell whether pages at depth may be handed out; call with the lock held */
+static bool levelReady(crawl_state_t *state, const int depth) {
+    for (int d = 0; d < depth; d++) {
+        if (state->holding[d] > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* function to write the frontier, the seen set and the next page id to pageDirectory/.checkpoint */
+static int checkpointSave(crawl_state_t *state) {
+    char path[strlen(state->pageDirectory) + 32], temp[strlen(state->pageDirectory) + 32];
+    sprintf(path, "%s/.checkpoint", state->pageDirectory);
+    sprintf(temp, "%s/.checkpoint.tmp", state->pageDirectory);
+    FILE *fp = fopen(temp, "w");
+    if (fp == NULL) {   // ensure checkpoint file was created
+        printErrorMessage("checkpointSave: could not create checkpoint.");
+        return -1;
+    }
+    fprintf(fp, "tse-checkpoint 2 %d %d %ld %ld\n", state->maxDepth, state->pageId,
+            logSize(state->pageDirectory, ".validators"), logSize(state->pageDirectory, ".neardup"));
+    bool saved = urlsetSave(state->pagesSeen, fp) && frontierSave(state->pagesToCrawl, fp);
+    if (fclose(fp) != 0 || !saved || rename(temp, path) != 0) {  // ensure every byte reached the file
+        printErrorMessage("checkpointSave: could not write checkpoint.");
+        remove(temp);
+        return -1;
+    }
+    return 0;
+}
+
+/* function to rebuild the frontier, the seen set and the next page id from pageDirectory/.checkpoint */
+static int checkpointLoad(crawl_state_t *state, const bool scored, const int window) {
+    char path[strlen(state->pageDirectory) + 32];
+    sprintf(path, "%s/.checkpoint", state->pageDirectory);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {   // ensure there is a checkpoint
+        return -1;
+    }
+    int version, maxDepth, pageId;
+    long validatorsSize, neardupSize;
+    state->pagesToCrawl = frontierNew(scored);
+    state->pagesSeen = urlsetNew(CrawlerCoeff);
+    if (fscanf(fp, "tse-checkpoint %d %d %d %ld %ld", &version, &maxDepth, &pageId, &validatorsSize, &neardupSize) != 5
+        || version != 2
+        || maxDepth != state->maxDepth || pageId < 1 || state->pagesToCrawl == NULL || state->pagesSeen == NULL
+        || !frontierSpill(state->pagesToCrawl, state->pageDirectory, window)
+        || !urlsetLoad(state->pagesSeen, fp) || !frontierLoad(state->pagesToCrawl, fp)) {
+        printErrorMessage("checkpointLoad: invalid checkpoint.");
+        fclose(fp);
+        frontierDelete(state->pagesToCrawl, webpage_delete);
+        urlsetDelete(state->pagesSeen);
+        state->pagesToCrawl = NULL;
+        state->pagesSeen = NULL;
+        return -1;
+    }
+    fclose(fp);
+    state->pageId = pageId;
+    // drop what was recorded after the checkpoint, so later readers and the next --recrawl do not see it
+    if (!logTruncate(state->pageDirectory, ".validators", validatorsSize)
+        || !logTruncate(state->pageDirectory, ".neardup", neardupSize)) {
+        return -1;
+    }
+    // drop pages saved after the checkpoint; ids are claimed before saving, so there may be gaps up to the end
+    if (state->store != NULL) {
+        return pagestoreTruncate(state->store, pageId) ? 0 : -1;
+    }
+    char docFile[strlen(state->pageDirectory) + 32];
+    for (int id = pageId, end = pageDirEnd(state->pageDirectory); id < end; id++) {
+        sprintf(docFile, "%s/%d", state->pageDirectory, id);
+        remove(docFile);
+    }
+    return 0;
+}
+
+/* function to get the size of a file in pageDirectory, 0 if there is none */
+static long logSize(const char *pageDirectory, const char *name) {
+    char path[strlen(pageDirectory) + strlen(name) + 2];
+    sprintf(path, "%s/%s", pageDirectory, name);
+    struct stat info;
+    return stat(path, &info) == 0 ? (long) info.st_size : 0;
+}
+
+/* function to cut a file in pageDirectory back to size bytes, if it has grown past them */
+static bool logTruncate(const char *pageDirectory, const char *name, const long size) {
+    char path[strlen(pageDirectory) + strlen(name) + 2];
+    sprintf(path, "%s/%s", pageDirectory, name);
+    return logSize(pageDirectory, name) <= size || truncate(path, (off_t) size) == 0;
+}
+
+/* function to index the pages saved by an earlier crawl of pageDirectory by url */
+static int knownLoad(crawl_state_t *state) {
+    http_validators_t *validators;
+    int count = pageDirLoadValidators(state->pageDirectory, &validators);
+    state->known = hashtable_new(count > CrawlerCoeff ? count : CrawlerCoeff);
+    // either kind of directory may have gaps, so read up to the largest id saved: ids on disk are never handed out
+    int end = state->store != NULL ? pagestoreEnd(state->store) : pageDirEnd(state->pageDirectory);
+    char *url;
+    for (int docID = 1; state->known != NULL && docID < end; docID++) {
+        url = state->store != NULL ? pagestoreUrl(state->store, docID) : getPageUrl(state->pageDirectory, docID);
+        if (url == NULL) {
             continue;
         }
-        // save the webpage to pageDirectory
-        if (webpage_getDepth(page) < maxDepth) {    // skip if at depth limit
-            if (pageScan(page, pagesSeen, pagesToCrawl) != 0) {  // ensure pagescan was successful
-                webpage_delete(page); // delete webpage
-                continue;
+        known_doc_t *doc = mem_calloc(1, sizeof(known_doc_t));
+        if (doc != NULL) {
+            doc->docID = docID;
+            if (docID < count) {    // move the validators into the table
+                doc->validators = validators[docID];
+                memset(&validators[docID], 0, sizeof(http_validators_t));
+            }
+            if (!hashtable_insert(state->known, url, doc)) {    // a url saved twice keeps its first file
+                knownDelete(doc);
             }
         }
-        pageId++;
-        webpage_delete(page); // delete webpage
+        mem_free(url);
+    }
+    for (int i = 0; i < count; i++) {
+        httpValidatorsClear(&validators[i]);
+    }
+    free(validators);
+    if (state->pageId < end) {    // new pages are saved after the known ones, even if they cannot be indexed
+        state->pageId = end;
+    }
+    if (state->known == NULL || end < 1) {  // ensure hashtable_new was successful and the directory could be read
+        return -1;
     }
-    mem_free((char *) seedUrl);
-    bag_delete(pagesToCrawl, NULL); // delete bag struct
-    hashtable_delete(pagesSeen, NULL); // delete hastable struct
     return 0;
 }
 
-/* function to fetch the html of a webpage into a webpage_t struct */
-static int pageFetch(webpage_t *page, const char *pageDirectory) {
-    if (page == NULL || pageDirectory == NULL) {    // ensure args are valid
+/* function to set up near-duplicate detection */
+static int nearLoad(crawl_state_t *state, const int maxDistance, const bool fresh) {
+    state->nearSeen = simsetNew(maxDistance);
+    char path[strlen(state->pageDirectory) + 32];
+    sprintf(path, "%s/.neardup", state->pageDirectory);
+    state->nearLog = state->nearSeen == NULL ? NULL : fopen(path, fresh ? "w" : "a");
+    if (state->nearLog == NULL) {
+        simsetDelete(state->nearSeen);
+        state->nearSeen = NULL;
+        return -1;
+    }
+    webpage_t *page;
+    for (int docID = 1; !fresh && docID < state->pageId; docID++) { // pages saved before: compare new pages with them
+        if (pageLoad(state, &page, docID) == 1) {
+            simsetAdd(state->nearSeen, simhashPage(webpage_getHTML(page)), docID);
+            webpage_delete(page);
+        }
+    }
+    return 0;
+}
+
+/* function to take the validators of a page saved by an earlier crawl, to send with its fetch */
+static void knownTake(crawl_state_t *state, const char *url, http_validators_t *validators) {
+    if (validators == NULL) {
+        return;
+    }
+    known_doc_t *doc = state->known == NULL ? NULL : hashtable_find(state->known, url);
+    if (doc == NULL) {
+        memset(validators, 0, sizeof(http_validators_t));
+        return;
+    }
+    *validators = doc->validators;
+    memset(&doc->validators, 0, sizeof(http_validators_t));
+}
+
+/* function to delete a known_doc_t */
+static void knownDelete(void *item) {
+    known_doc_t *doc = item;
+    if (doc != NULL) {
+        httpValidatorsClear(&doc->validators);
+        mem_free(doc);
+    }
+}
+
+/* function to score a link for a scored frontier */
+static int linkScore(const char *url) {
+    int segments = 0;
+    const char *path = strncmp(url, "http://", 7) == 0 ? strchr(url + 7, '/') : NULL;
+    for (; path != NULL; path = strchr(path + 1, '/')) {
+        segments++;
+    }
+    return -segments;
+}
+
+/* function to wait until the scheduler allows n more fetches to the host of url and claim them */
+static char *hostAcquire(crawl_state_t *state, const char *url, const int n) {
+    char *hostname, *pathname;
+    int port;
+    if (!httpBurstURL(url, &hostname, &port, &pathname)) {   // fetch will fail anyway
+        return NULL;
+    }
+    mem_free(pathname);
+    hostschedAcquire(state->sched, hostname, n);  // be polite: wait for the host's policy to allow the fetches
+    return hostname;
+}
+
+/* function to release a host claimed with hostAcquire */
+static void hostRelease(crawl_state_t *state, char *hostname) {
+    if (hostname == NULL) {
+        return;
+    }
+    hostschedRelease(state->sched, hostname);
+    mem_free(hostname);
+}
+
+/* function to fetch the html of webpages of one host into webpage_t structs */
+static int pageFetch(webpage_t **pages, http_validators_t *validators, const int n) {
+    if (pages == NULL || validators == NULL || n < 1) {    // ensure args are valid
         printErrorMessage("pageFetch: invalid args.");
         return -1;
     }
-    if (!webpage_fetch(page)) { // ensure webpage_fetch was succesful
-        printErrorMessage(webpage_getURL(page));
+    if (httpFetchAllConditional(pages, n, validators) != n) { // ensure httpFetchAllConditional was succesful
+        for (int i = 0; i < n; i++) {
+            if (webpage_getHTML(pages[i]) == NULL && !validators[i].notModified) {
+                printErrorMessage(webpage_getURL(pages[i]));
+            }
+        }
         printErrorMessage("pageFetch: webpage fetch failed.");
         return -1;
     }
@@ -281,59 +1352,83 @@ static int pageFetch(webpage_t *page, const char *pageDirectory) {
 }
 
 /* function to scan/parse a webpage using the webpage_t struct and extract all urls and links in the page */
-static int pageScan(webpage_t *page, hashtable_t *pagesSeen, bag_t *pagesToCrawl) {
-    if (page == NULL || pagesSeen == NULL || pagesToCrawl == NULL) { // ensure args are valie
+static int pageScan(webpage_t *page, crawl_state_t *state) {
+    if (page == NULL || state == NULL) { // ensure args are valie
         printErrorMessage("pageScan: invalid args.");
         return -1;
     }
-    int pos = 0;
-    // ensure webpage_getNextURL was succesful; nexturl is fred when hastable is deleted
-    char *nextUrl = webpage_getNextURL(page, &pos);
-    for (; nextUrl != NULL; nextUrl = webpage_getNextURL(page, &pos)) { 
-        char *url = normalizeURL(nextUrl); // normalize url, will be freed when webpage is deleted
-        if (url == NULL) { // ensure normalie url was successful
+    const char *html = webpage_getHTML(page);
+    const char *base = webpage_getURL(page);
+    char scratch[LinkMax];  // links are resolved here; only new urls are copied out
+    bool failed = false;    // a url was dropped because the seen set could not grow
+    size_t pos = 0;
+    link_span_t link;
+    while (linkscanNext(html, &pos, &link)) {   // spans into html, which is left as fetched
+        size_t size = linkscanSize(base, &link);
+        char *buf = size <= sizeof(scratch) ? scratch : mem_malloc(size);
+        size_t len = buf == NULL ? 0 : linkscanResolve(base, html, &link, buf, size);
+        if (len == 0) { // ensure the link normalized to an http url
             printErrorMessage("pageScan: normalize url failed.");
-            mem_free(nextUrl);
+            if (buf != scratch && buf != NULL) mem_free(buf);
             continue;
         }
-        if (!isInternalURL(url)) {  // ensure url is an internal url
+        if (!allowlistMatch(state->allowed, buf)) {  // ensure url is on an allowed host (one probe, no parsing)
             printErrorMessage("pageScan: external url.");
-            mem_free(url);
-            mem_free(nextUrl);
+            if (buf != scratch) mem_free(buf);
             continue;
         }
-        if (hashtable_find(pagesSeen, url) != NULL || hashtable_find(pagesSeen, nextUrl) != NULL) { // ensure url has not been seen before
-            printErrorMessage("pageScan: duplicate url.");
-            mem_free(url);
-            mem_free(nextUrl);
+        uint64_t fingerprint = urlsetFingerprint(buf);  // hash before taking the lock
+        pthread_mutex_lock(&state->lock);
+        int added = urlsetInsertFingerprint(state->pagesSeen, fingerprint);
+        if (added != 1) { // ensure url has not been seen before, and is now in the seen set
+            pthread_mutex_unlock(&state->lock);
+            printErrorMessage(added == 0 ? "pageScan: duplicate url." : "pageScan: seen set could not grow, url dropped.");
+            failed = failed || added < 0;
+            if (buf != scratch) mem_free(buf);
             continue;
         }
-        hashtable_insert(pagesSeen, nextUrl, "");
-        hashtable_insert(pagesSeen, url, "");
-        char *html = NULL;
-        webpage_t *tempPage = webpage_new(url, webpage_getDepth(page) + 1, html);
+        char *url = mem_malloc(len + 1);    // a new url: now it needs its own copy, freed with its webpage
+        if (url != NULL) memcpy(url, buf, len + 1);
+        if (buf != scratch) mem_free(buf);
+        webpage_t *tempPage = webpage_new(url, webpage_getDepth(page) + 1, NULL);
         if (tempPage == NULL) { // ensure webpage_new was succesful
             printErrorMessage("pageScan: webpage new failed.");
             mem_free(url);
-            mem_free(nextUrl);
-            continue;
+        } else if (!frontierPush(state->pagesToCrawl, tempPage, linkScore(url))) { // add webpage to frontier
+            webpage_delete(tempPage);
         }
-        bag_insert(pagesToCrawl, tempPage); // add webpage to bag
-        mem_free(nextUrl);
+        pthread_cond_broadcast(&state->changed);   // wake idle workers
+        pthread_mutex_unlock(&state->lock);
     }
-    return 0;
+    return failed ? -1 : 0;
 }
 
 /* function to save a webpages url, depth from seed and html into a file identified by pageId */
-static int pageSave(webpage_t *page, const char *pageDirectory, const int pageId) {
+static int pageSave(webpage_t *page, const char *pageDirectory, pagestore_t *store, const bool compress,
+                                                                                        const int pageId) {
     if (page == NULL || pageId < 0) { // ensureargs are valid
         printErrorMessage("pageSave: invalid args.");
         return -1;
     }
-    pageDirSave(page, pageDirectory, pageId);
+    if (store != NULL) {
+        return pagestorePut(store, page, pageId, compress) ? 0 : -1;
+    }
+    if (compress) {
+        pageDirSaveCompressed(page, pageDirectory, pageId);
+    } else {
+        pageDirSave(page, pageDirectory, pageId);
+    }
     return 0;
 }
 
+/* function to load a page saved by this or an earlier crawl of pageDirectory */
+static int pageLoad(crawl_state_t *state, webpage_t **page, const int docID) {
+    if (state->store != NULL) {
+        return pagestoreLoad(state->store, page, docID);
+    }
+    return pageDirLoad(page, state->pageDirectory, docID);
+}
+
 /* functino to print error pessages only when in DEV or TEST modes */
 static void printErrorMessage(const char *message) {
     #ifdef TEST
@@ -6,6 +6,130 @@ echo "TESTING CRAWLER"
 idx=0
 
 
+echo "TESTING FUNCTIONALITY -> crawler modes against tseserver serving ../test"
+# every mode must save the 585 pages of the serial crawl, whatever ids they get
+PORT=${PORT:-8080}
+VALGRIND=$1
+out=$(mktemp -d)
+if [[ ! -x ../bench/tseserver || ! -x ../indexer/indexer ]]
+then
+    echo "TEST FAILED: build ../bench/tseserver and ../indexer/indexer first"
+else
+    ../bench/tseserver -d ../test -p "$PORT" > "$out/server.txt" &
+    server=$!
+    ../bench/tseserver -d ../test -p $((PORT + 1)) -l 100 > "$out/slow.txt" &
+    slow=$!
+    trap 'kill $server $slow 2> /dev/null; rm -rf "$out"' EXIT
+    for try in {1..50}
+    do
+        [[ -s "$out/server.txt" && -s "$out/slow.txt" ]] && break
+        sleep 0.1
+    done
+    seed=$(head -1 "$out/server.txt" | awk '{ print $NF }')
+
+    # crawls a fresh directory: crawlDir <name> <crawler options>
+    crawlDir() {
+        local dir="$out/$1"
+        shift
+        mkdir "$dir"
+        echo "$VALGRIND ./crawler $seed <pageDirectory> 2 -d 0 -p 8 $* --connect 127.0.0.1:$PORT"
+        export output=$($VALGRIND ./crawler "$seed" "$dir" 2 -d 0 -p 8 "$@" --connect "127.0.0.1:$PORT" 2>&1)
+    }
+    # prints the urls saved in a directory of page files, sorted
+    urlsOf() {
+        for page in "$1"/[0-9]*
+        do
+            head -1 "$page"
+        done | sort
+    }
+    # reports a crawl: checkCrawl <failure message or "">
+    checkCrawl() {
+        if [[ $1 != "" ]]
+        then
+            echo "TEST FAILED: $1"
+        elif [[ $VALGRIND == "" || $output == *"All heap blocks were freed"*"0 errors"* ]]
+        then
+            echo "TEST PASSED!"
+        else
+            echo "TEST FAILED: valgrind errors."
+        fi
+    }
+    crawlDir serial
+    urlsOf "$out/serial" > "$out/serial.urls"
+    if [[ $(wc -l < "$out/serial.urls") != 585 || $(uniq "$out/serial.urls" | wc -l) != 585 ]]
+    then
+        checkCrawl "serial crawl should save the 585 pages of ../test once each"
+    else
+        checkCrawl ""
+    fi
+
+    mode=0
+    for flags in "-t 4" "-e 16" "-k 4" "-t 4 -k 4" "-o score" "-m 16" "-s 2 -w 2" "--compress" "-c 50"
+    do
+        mode=$((mode + 1))
+        crawlDir "mode$mode" $flags
+        if ! urlsOf "$out/mode$mode" | cmp -s - "$out/serial.urls"
+        then
+            checkCrawl "$flags should save the same urls as the serial crawl"
+        else
+            checkCrawl ""
+        fi
+    done
+
+    echo "TESTING FUNCTIONALITY -> packed and compressed crawls read back through the indexer"
+    ../indexer/indexer "$out/serial" "$out/serial.index" > /dev/null 2>&1
+    sort "$out/serial.index" > "$out/serial.sorted"
+    for flags in "--packed" "--packed --compress" "--compress"
+    do
+        mode=$((mode + 1))
+        crawlDir "mode$mode" $flags
+        ../indexer/indexer "$out/mode$mode" "$out/mode$mode.index" > /dev/null 2>&1
+        if ! sort "$out/mode$mode.index" | cmp -s - "$out/serial.sorted"
+        then
+            checkCrawl "the index of a $flags crawl should match the index of the serial crawl"
+        else
+            checkCrawl ""
+        fi
+    done
+
+    echo "TESTING FUNCTIONALITY -> interrupted crawl resumed from its checkpoint"
+    mkdir "$out/resume"
+    slowSeed=$(head -1 "$out/slow.txt" | awk '{ print $NF }')
+    echo "timeout -s INT 2 ./crawler $slowSeed <pageDirectory> 2 -d 0 -p 8 -t 8 -c 20, then --resume"
+    timeout -s INT 2 ./crawler "$slowSeed" "$out/resume" 2 -d 0 -p 8 -t 8 -c 20 --connect "127.0.0.1:$((PORT + 1))" > /dev/null 2>&1
+    if [[ ! -e "$out/resume/.checkpoint" ]]
+    then
+        checkCrawl "the interrupted crawl should leave a checkpoint"
+    else
+        export output=$($VALGRIND ./crawler "$slowSeed" "$out/resume" 2 -d 0 -p 8 -t 8 -c 20 --resume --connect "127.0.0.1:$((PORT + 1))" 2>&1)
+        if [[ -e "$out/resume/.checkpoint" ]]
+        then
+            checkCrawl "the resumed crawl should finish and remove the checkpoint"
+        elif ! urlsOf "$out/resume" | cmp -s - "$out/serial.urls"
+        then
+            checkCrawl "the resumed crawl should save the same urls as the serial crawl, once each"
+        else
+            checkCrawl ""
+        fi
+    fi
+
+    echo "TESTING FUNCTIONALITY -> near-duplicate pages are logged to .neardup"
+    mode=$((mode + 1))
+    crawlDir "mode$mode" -n 3
+    neardup="$out/mode$mode/.neardup"
+    if [[ ! -e $neardup || $(wc -l < "$neardup") != 18 || $(cut -d ' ' -f 2 "$neardup" | sort -u | wc -l) != 18 ]]
+    then
+        checkCrawl "-n 3 should log 18 distinct pages to .neardup"
+    elif ! (urlsOf "$out/mode$mode"; cut -d ' ' -f 2 "$neardup") | sort | cmp -s - "$out/serial.urls"
+    then
+        checkCrawl "-n 3 should save or log every url of the serial crawl, and not both"
+    else
+        checkCrawl ""
+    fi
+
+    kill $server $slow 2> /dev/null
+fi
+
 echo "TESTING FUNCTIONALITY -> does it work"
 mkdir ../test 2> /dev/null
 
@@ -13,11 +13,45 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
 #include "mem.h"
 #include "webpage.h"
 #include "hashtable.h"
 #include "pagedir.h"
 #include "index.h"
+#include "pagemap.h"
+#include "urltable.h"
+#include "wordscan.h"
+
+#ifndef MaxIndexThreads
+#define MaxIndexThreads 64 // most workers -j may ask for
+#endif
+
+#ifndef RunName
+#define RunName "%s.run%d.%d" // runs are written next to the index file: <indexFile>.run<worker>.<run>
+#endif
+#define RunNameExtra 32 // bytes a run name needs besides the index file name
+
+
+/**
+ * @brief a worker of indexBuild and what it built: an index and url table of its own, needing no lock
+ * 
+ */
+typedef struct indexWorker {
+    const char *pageDir;    // crawler directory being indexed
+    int first;              // first docID the worker indexes
+    int end;                // one more than the last docID the worker indexes
+    const char *indexFile;  // index file being built, runs are named after
+    int id;                 // position of the worker
+    size_t budget;          // heap index may take before it is written out as a run (0 for no limit)
+    size_t bytes;           // heap index takes (see indexAddLower)
+    int runs;               // runs written
+    bool failed;            // set if a run could not be written
+    index_t *index;         // index of the pages the worker read since its last run
+    urltable_t *urls;       // docID -> url of the pages the worker read
+    pthread_t thread;       // thread running the worker
+} index_worker_t;
 
 /**
  * @brief functino to print error pessages only when in DEV or TEST modes
@@ -33,12 +67,17 @@ static void printErrorMessage(const int argc, ...);
 /**
  * @brief helper function to parse args from main into variables
  * 
+ * @param argc number of arguments
  * @param args string array containing arguments to indexer
+ * @param threads pointer to store the number of workers (-j threads, 1 if not given)
+ * @param budget pointer to store the memory budget in bytes (-m megabytes, 0 if not given)
+ * @param binary pointer to store whether to save the index in binary (-b)
  * @return int 
  * - 0 if success
  * - 1 if failure
  */
-static int parseArgs(const char *args[], char **pageDir, char **indexFile);
+static int parseArgs(const int argc, const char *args[], char **pageDir, char **indexFile, int *threads,
+                                                                            size_t *budget, bool *binary);
 
 /**
  * @brief  creates a new 'index' object
@@ -47,36 +86,102 @@ static int parseArgs(const char *args[], char **pageDir, char **indexFile);
            passes the webpage and docID to indexPage
  * @param pageDir
  * @param indexFile
+ * @param threads number of workers: each indexes a range of docIDs into an index of its own, and the indexes
+ *        are then merged in pairs, the pairs of a round at once. Each word's docIDs keep the order a single
+ *        worker gives them
+ * @param budget heap the indexes may take together, 0 for no limit. A worker whose index reaches its share
+ *        writes it out sorted as a run and starts a new one; if any did, the runs are merged into indexFile
+ *        instead of the indexes
+ * @param binary save indexFile with indexSaveBinary rather than indexSave
  * @return int 
  * - 0 if successful
  * - 1 if something went wrong
  */
-static int indexBuild (const char *pageDir, const char *indexFile);
+static int indexBuild (const char *pageDir, const char *indexFile, const int threads, const size_t budget,
+                                                                                            const bool binary);
+
+/**
+ * @brief function run by every worker of indexBuild: index its range of docIDs
+ * 
+ * @param arg index_worker_t of the worker
+ * @return void* NULL
+ */
+static void *indexWorker(void *arg);
+
+/**
+ * @brief function run by a thread of the merge: add the index of the second worker of a pair to the first's
+ * 
+ * @param arg the pair: two index_worker_t in a row
+ * @return void* NULL
+ */
+static void *mergeWorker(void *arg);
+
+/**
+ * @brief function to merge the indexes of the workers into the first's: pairs of indexes are merged into the
+ *        earlier of each, a round at a time, the pairs of a round at once
+ * 
+ * @param workers workers, in docID order
+ * @param n number of workers
+ */
+static void mergeIndexes(index_worker_t workers[], const int n);
+
+/**
+ * @brief function to write the index of a worker out as its next run and give it an empty one
+ * 
+ * @param worker worker to flush
+ * @return int 0 if success ; -1 if failure (worker->failed is set)
+ */
+static int workerFlush(index_worker_t *worker);
+
+/**
+ * @brief function to write what is left in the workers' indexes as runs, merge every run into the index file
+ *        and remove the runs
+ * 
+ * @param workers workers, in docID order
+ * @param n number of workers
+ * @param binary merge into a binary index file
+ * @return int 0 if success ; -1 if failure
+ */
+static int mergeRuns(index_worker_t workers[], const int n, const bool binary);
+
+/**
+ * @brief function to write the name of a run of a worker to buf
+ * 
+ * @param buf buffer of at least strlen(indexFile) + RunNameExtra bytes
+ */
+static void runName(char *buf, const char *indexFile, const int worker, const int run);
 
 /**
  * @brief steps through each word of the webpage
  *        looks up the word in the index
  *        increments the count of occurrences of this word
- * @param page : webpage to get words from
+ * @param page : view of the webpage to get words from (see pagemap)
  * @param index : index to update
  * @param docID : document id
+ * @param scratch : buffer each word is lower cased into for indexAddLower, grown as needed and kept across pages
+ * @param size : size of scratch
+ * @param bytes : heap index takes, grown by what the page adds
  * 
  */
-static void indexPage(webpage_t *page, index_t *index, const int docID);
+static void indexPage(const page_view_t *page, index_t *index, const int docID, char **scratch, size_t *size,
+                                                                                            size_t *bytes);
 
 int main(int argc, char const *argv[])
 {
-    if (argc != 3) {    // ensure arguments are valid
-        printf("Usage: indexer <pageDir> <indexFile>\n");
+    if (argc < 3 || argc > 8) {    // ensure arguments are valid
+        printf("Usage: indexer <pageDir> <indexFile> [-j threads] [-m megabytes] [-b]\n");
         exit(-1);
     }
     char *pageDir, *indexFile;  // pointers to parsed args
-    if (parseArgs(argv, &pageDir, &indexFile) == -1) {  // parse args and ensure correctnes
+    int threads;
+    size_t budget;
+    bool binary;
+    if (parseArgs(argc, argv, &pageDir, &indexFile, &threads, &budget, &binary) == -1) {  // parse args and ensure correctnes
         printErrorMessage(1, "Bag Arguments\n");
         exit(-1);
     }
 
-    if (indexBuild(pageDir, indexFile) != 0) {  // if indexBuild was successful
+    if (indexBuild(pageDir, indexFile, threads, budget, binary) != 0) {  // if indexBuild was successful
         printErrorMessage(1, "main: something went wrong with indexBuild\n");
     }
     mem_free(pageDir);
@@ -87,16 +192,38 @@ int main(int argc, char const *argv[])
 /**
  * @brief helper function to parse args from main into variables
  * 
+ * @param argc number of arguments
  * @param args string array containing arguments to indexer
+ * @param threads pointer to store the number of workers (-j threads, 1 if not given)
  * @return int 
  * - 0 if success
  * - 1 if failure
  */
-static int parseArgs(const char *args[], char **pageDir, char **indexFile) {
-    if (args == NULL || pageDir == NULL || indexFile == NULL) { // validate arguments
-        printErrorMessage(1, "parseArgs: Invlaid arguments\n");
+static int parseArgs(const int argc, const char *args[], char **pageDir, char **indexFile, int *threads,
+                                                                            size_t *budget, bool *binary) {
+    if (args == NULL || pageDir == NULL || indexFile == NULL || threads == NULL || budget == NULL
+                                                                                    || binary == NULL) {
+        printErrorMessage(1, "parseArgs: Invlaid arguments\n");    // validate arguments
         return -1;
     }
+    *threads = 1;
+    *budget = 0;
+    *binary = false;
+    for (int i = 3; i < argc; i++) {    // options
+        long value = i + 1 < argc ? strtol(args[i + 1], NULL, 10) : 0;
+        if (strcmp(args[i], "-b") == 0) {   // -b
+            *binary = true;
+        } else if (strcmp(args[i], "-j") == 0 && value >= 1 && value <= MaxIndexThreads) {    // -j threads
+            *threads = (int) value;
+            i++;
+        } else if (strcmp(args[i], "-m") == 0 && value >= 1) {  // -m megabytes
+            *budget = (size_t) value << 20;
+            i++;
+        } else {
+            printErrorMessage(1, "parseArgs: Invalid option\n");
+            return -1;
+        }
+    }
     
     *pageDir = mem_calloc(strlen(args[1]) + 1, sizeof(char));   // alloate space for pageDir
     if (*pageDir == NULL) { // in case calloc for page dir fails
@@ -130,46 +257,234 @@ static int parseArgs(const char *args[], char **pageDir, char **indexFile) {
  * - 0 if successful
  * - 1 if something went wrong
  */
-static int indexBuild (const char *pageDir, const char *indexFile) {
-    if (pageDir == NULL || indexFile == NULL) { // validate arguments
+static int indexBuild (const char *pageDir, const char *indexFile, const int threads, const size_t budget,
+                                                                                            const bool binary) {
+    if (pageDir == NULL || indexFile == NULL || threads < 1 || threads > MaxIndexThreads) { // validate arguments
         printErrorMessage(2, "indexBuild: Invalid Args\n");
         return -1;
     }
-    int docID = 1;  // starting doc id
-    index_t *index = indexInit(IndexCoeff);
-    int loaded = 0; // used to teminate loop
-    for (; loaded != -1; docID++) { // loop web page fils to load; -1 is used to indicate the file does not exists so terminate
-        webpage_t *page = NULL;
-        loaded = pageDirLoad(&page, pageDir, docID);    // locad a webpage
-        if (loaded == -1 || loaded == 0) {
+    pagemap_t *map = pagemapOpen(pageDir);
+    if (map == NULL) {
+        printErrorMessage(2, "indexBuild: could not open pageDir\n");
+        return -1;
+    }
+    const int end = pagemapEnd(map);    // docIDs past the first missing page file are not indexed
+    pagemapClose(map);
+    index_worker_t workers[MaxIndexThreads];
+    int n = 0;
+    for (; n < threads; n++) {  // split the docIDs into ranges, the later ranges going to the later workers
+        workers[n].pageDir = pageDir;
+        workers[n].indexFile = indexFile;
+        workers[n].id = n;
+        workers[n].budget = budget / threads;
+        workers[n].bytes = 0;
+        workers[n].runs = 0;
+        workers[n].failed = false;
+        workers[n].first = 1 + (int) ((long) (end - 1) * n / threads);
+        workers[n].end = 1 + (int) ((long) (end - 1) * (n + 1) / threads);
+        workers[n].index = indexInit(IndexCoeff);
+        workers[n].urls = urltableNew();
+        if (workers[n].index == NULL || workers[n].urls == NULL) {
+            indexDelete(workers[n].index);
+            urltableDelete(workers[n].urls);
+            break;
+        }
+    }
+    if (n == 0) {
+        printErrorMessage(2, "indexBuild: out of memory\n");
+        return -1;
+    }
+    workers[n - 1].end = end;   // the last worker takes the ranges of those that could not be set up
+    int started = 0;
+    for (; n > 1 && started < n; started++) {  // a single worker runs on this thread
+        if (pthread_create(&workers[started].thread, NULL, indexWorker, &workers[started]) != 0) {
+            break;
+        }
+    }
+    for (int i = (n > 1 ? started : 0); i < n; i++) {  // workers that could not be started run on this thread
+        indexWorker(&workers[i]);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    int runs = 0, status = 0;
+    for (int i = 0; i < n; i++) {
+        runs += workers[i].runs + (workers[i].failed ? 1 : 0);
+    }
+    if (runs > 0) {     // some index outgrew the budget: write what is left as runs too, and merge the runs
+        status = mergeRuns(workers, n, binary);
+    } else {
+        mergeIndexes(workers, n);
+        if (binary) {   // save index to file
+            status = indexSaveBinary(workers[0].index, indexFile);
+        } else {
+            indexSave(workers[0].index, indexFile);
+        }
+        indexDelete(workers[0].index);
+    }
+
+    urltable_t *urls = urltableNew();   // docID -> url, saved next to the index for the querier
+    for (int i = 0; i < n; i++) {   // gather the urls from the workers, in docID order
+        for (int docID = workers[i].first; urls != NULL && docID < workers[i].end; docID++) {
+            const char *url = urltableGet(workers[i].urls, docID);
+            if (url != NULL) {
+                urltableAdd(urls, docID, url, strlen(url));
+            }
+        }
+        urltableDelete(workers[i].urls);
+    }
+    char urlFile[strlen(indexFile) + sizeof(UrltableSuffix)];
+    sprintf(urlFile, "%s%s", indexFile, UrltableSuffix);
+    if (urls == NULL || !urltableSave(urls, urlFile)) {  // the querier then reads urls from the pages
+        printErrorMessage(2, "indexBuild: could not save the url table\n");
+        remove(urlFile);
+    }
+    urltableDelete(urls);
+    return status;
+}
+
+/* function run by every worker of indexBuild */
+static void *indexWorker(void *arg) {
+    index_worker_t *worker = arg;
+    pagemap_t *map = pagemapOpen(worker->pageDir);  // pages are read in place from mappings, never copied
+    char *scratch = NULL;   // word buffer shared by every page
+    size_t scratchSize = 0;
+    for (int docID = worker->first; map != NULL && docID < worker->end; docID++) {
+        page_view_t page;
+        if (pagemapGet(map, docID, &page) != 1) {   // map a webpage
             continue;
         }
-        indexPage(page, index, docID);  // index the webpage
-        webpage_delete(page);
+        indexPage(&page, worker->index, docID, &scratch, &scratchSize, &worker->bytes);  // index the webpage
+        urltableAdd(worker->urls, docID, page.url, page.urlLen);
+        if (worker->budget > 0 && worker->bytes >= worker->budget && workerFlush(worker) != 0) {
+            break;
+        }
     }
-    indexSave(index, indexFile);    // save index to file
-    indexDelete(index);
+    free(scratch);
+    pagemapClose(map);
+    return NULL;
+}
+
+/* function run by a thread of the merge */
+static void *mergeWorker(void *arg) {
+    index_worker_t *pair = arg;
+    indexMerge(pair[0].index, pair[1].index);
+    indexDelete(pair[1].index);
+    return NULL;
+}
+
+/* function to merge the indexes of the workers into the first's */
+static void mergeIndexes(index_worker_t workers[], const int n) {
+    for (int step = 1; step < n; step *= 2) {   // merge pairs of indexes into the earlier of each, a round at a time
+        index_worker_t pairs[MaxIndexThreads][2];
+        pthread_t mergers[MaxIndexThreads];
+        int pairCount = 0, running = 0;
+        for (int i = 0; i + step < n; i += 2 * step, pairCount++) {
+            pairs[pairCount][0] = workers[i];
+            pairs[pairCount][1] = workers[i + step];
+        }
+        for (; running < pairCount && pthread_create(&mergers[running], NULL, mergeWorker, pairs[running]) == 0;
+                                                                                                running++);
+        for (int i = running; i < pairCount; i++) {     // merge on this thread those that could not be started
+            mergeWorker(pairs[i]);
+        }
+        for (int i = 0; i < running; i++) {
+            pthread_join(mergers[i], NULL);
+        }
+    }
+}
+
+/* function to write the index of a worker out as its next run */
+static int workerFlush(index_worker_t *worker) {
+    char name[strlen(worker->indexFile) + RunNameExtra];
+    runName(name, worker->indexFile, worker->id, worker->runs);
+    index_t *index = indexInit(IndexCoeff);
+    if (index == NULL || indexSaveSorted(worker->index, name) != 0) {
+        printErrorMessage(2, "workerFlush: could not write a run\n");
+        indexDelete(index);
+        worker->failed = true;
+        return -1;
+    }
+    indexDelete(worker->index);
+    worker->index = index;
+    worker->bytes = 0;
+    worker->runs++;
     return 0;
 }
 
+/* function to merge every run into the index file */
+static int mergeRuns(index_worker_t workers[], const int n, const bool binary) {
+    const char *indexFile = workers[0].indexFile;
+    int count = 0, status = 0;
+    for (int i = 0; i < n; i++) {   // what is left in memory is a run too
+        if (workers[i].failed || (workers[i].bytes > 0 && workerFlush(&workers[i]) != 0)) {
+            status = -1;    // pages are missing from the runs
+        }
+        indexDelete(workers[i].index);
+        count += workers[i].runs;
+    }
+    char **runs = mem_calloc(count, sizeof(char *));
+    for (int i = 0, k = 0; runs != NULL && i < n; i++) {  // runs in docID order: by worker, then as written
+        for (int run = 0; run < workers[i].runs; run++, k++) {
+            runs[k] = mem_malloc(strlen(indexFile) + RunNameExtra);
+            if (runs[k] == NULL) {
+                status = -1;
+                continue;
+            }
+            runName(runs[k], indexFile, i, run);
+        }
+    }
+    if (runs == NULL || status != 0 || indexMergeRuns((const char **) runs, count, indexFile, binary) != 0) {
+        printErrorMessage(2, "mergeRuns: could not merge the runs\n");
+        status = -1;
+    }
+    for (int k = 0; runs != NULL && k < count; k++) {
+        if (runs[k] != NULL) {
+            remove(runs[k]);
+            mem_free(runs[k]);
+        }
+    }
+    if (runs != NULL) {
+        mem_free(runs);
+    }
+    return status;
+}
+
+/* function to write the name of a run */
+static void runName(char *buf, const char *indexFile, const int worker, const int run) {
+    sprintf(buf, RunName, indexFile, worker, run);
+}
+
 /**
  * @brief steps through each word of the webpage
  *        looks up the word in the index
  *        increments the count of occurrences of this word
- * @param page : webpage to get words from
+ * @param page : view of the webpage to get words from (see pagemap)
  * @param index : index to update
  * @param docID : document id
+ * @param scratch : buffer each word is lower cased into for indexAddLower, grown as needed and kept across pages
+ * @param size : size of scratch
  * 
  */
-static void indexPage(webpage_t *page, index_t *index, const int docID) {
-    if (page == NULL || index == NULL || docID < 1) {   // validate arguments
+static void indexPage(const page_view_t *page, index_t *index, const int docID, char **scratch, size_t *size,
+                                                                                            size_t *bytes) {
+    if (page == NULL || index == NULL || docID < 1 || scratch == NULL || size == NULL) {   // validate arguments
         return;
     }
-    int pos = 0;    // used for reading words from webpage
-    char *word = webpage_getNextWord(page, &pos);
-    for (; word != NULL; word = webpage_getNextWord(page, &pos)) {  // loop for all words in webpage
-        if (strlen(word) >= 3) indexAdd(index, word, docID);    // add count for word to index
-        mem_free(word);
+    size_t pos = 0;
+    word_span_t word;
+    while (wordscanNext(page->html, page->htmlLen, &pos, &word)) {  // the words webpage_getNextWord would give
+        if (word.len + 1 > *size) {  // grow the scratch buffer to hold the word
+            char *grown = realloc(*scratch, 2 * (word.len + 1));
+            if (grown == NULL) {
+                return;
+            }
+            *scratch = grown;
+            *size = 2 * (word.len + 1);
+        }
+        wordscanLower(page->html, &word, *scratch, *size);
+        indexAddLower(index, *scratch, docID, bytes);  // add count for word to index; only a new word is copied
     }
 }
 
@@ -27,6 +27,65 @@ else
 fi
 
 
+# Testing indexer with letters-1 and 4 workers (the same lines as the serial index, in another order)
+sort index.txt > sindex.txt
+export output=$($1 ./indexer letters-1 index.txt -j 4 2>&1)
+if [[ $1 == "" ]]
+then
+    echo "TEST PASSED! ./indexer letters-1 index.txt -j 4"
+elif [[ $output == *"All heap blocks were freed"*"0 errors"* ]]
+then
+    echo "TEST PASSED! ./indexer letters-1 index.txt -j 4"
+else
+    echo "TEST FAILED: Valgrind errors. ./indexer letters-1 index.txt -j 4"
+fi
+if sort index.txt | cmp -s - sindex.txt
+then
+    echo "TEST PASSED! ./indexer letters-1 index.txt -j 4 matches ./indexer letters-1 index.txt"
+else
+    echo "TEST FAILED! ./indexer letters-1 index.txt -j 4 differs from ./indexer letters-1 index.txt"
+fi
+export output=$($1 ./indextest index.txt nindex.txt 2>&1)
+if [[ $1 == "" && $output == *"TEST PASSED"* ]]
+then
+    echo "TEST PASSED! ./indextest index.txt nindex.txt"
+elif [[ $1 == "" ]]
+then
+    echo "TEST FAILED! ./indextest index.txt nindex.txt"
+elif [[ $output == *"TEST PASSED"*"All heap blocks were freed"*"0 errors"* ]]
+then
+    echo "TEST PASSED! ./indextest index.txt nindex.txt"
+else
+    echo "TEST FAILED: Valgrind errors. ./indextest index.txt nindex.txt"
+fi
+
+
+# Testing indexer with letters-1 and a binary index
+export output=$($1 ./indexer letters-1 index.txt -b 2>&1)
+if [[ $1 == "" ]]
+then
+    echo "TEST PASSED! ./indexer letters-1 index.txt -b"
+elif [[ $output == *"All heap blocks were freed"*"0 errors"* ]]
+then
+    echo "TEST PASSED! ./indexer letters-1 index.txt -b"
+else
+    echo "TEST FAILED: Valgrind errors. ./indexer letters-1 index.txt -b"
+fi
+export output=$($1 ./indextest index.txt nindex.txt 2>&1)
+if [[ $1 == "" && $output == *"TEST PASSED"* ]]
+then
+    echo "TEST PASSED! ./indextest index.txt nindex.txt"
+elif [[ $1 == "" ]]
+then
+    echo "TEST FAILED! ./indextest index.txt nindex.txt"
+elif [[ $output == *"TEST PASSED"*"All heap blocks were freed"*"0 errors"* ]]
+then
+    echo "TEST PASSED! ./indextest index.txt nindex.txt"
+else
+    echo "TEST FAILED: Valgrind errors. ./indextest index.txt nindex.txt"
+fi
+
+
 # Testing indexer with letters-10
 export output=$($1 ./indexer ../../shared/tse/output/letters-10 index.txt 2>&1)
 if [[ $1 == "" ]]
@@ -53,6 +112,46 @@ else
 fi
 
 
+
+# Testing indexer with letters-10 and a 1 megabyte budget (runs merged to the same lines as the serial index)
+sort index.txt > sindex.txt
+for flags in "-m 1" "-m 1 -j 4" "-m 1 -b" "-m 1 -j 4 -b"
+do
+    export output=$($1 ./indexer ../../shared/tse/output/letters-10 index.txt $flags 2>&1)
+    if [[ $1 == "" ]]
+    then
+        echo "TEST PASSED! ./indexer letters-10 index.txt $flags"
+    elif [[ $output == *"All heap blocks were freed"*"0 errors"* ]]
+    then
+        echo "TEST PASSED! ./indexer letters-10 index.txt $flags"
+    else
+        echo "TEST FAILED: Valgrind errors. ./indexer letters-10 index.txt $flags"
+    fi
+    export output=$($1 ./indextest index.txt nindex.txt 2>&1)
+    if [[ $output != *"TEST PASSED"* ]]
+    then
+        echo "TEST FAILED! ./indextest index.txt nindex.txt"
+    elif [[ $1 != "" && $output != *"All heap blocks were freed"*"0 errors"* ]]
+    then
+        echo "TEST FAILED: Valgrind errors. ./indextest index.txt nindex.txt"
+    fi
+    text=index.txt
+    if [[ $flags == *"-b"* ]]     # compare the text indextest writes from the binary index
+    then
+        text=nindex.txt
+    fi
+    if sort $text | cmp -s - sindex.txt
+    then
+        echo "TEST PASSED! ./indexer letters-10 index.txt $flags matches ./indexer letters-10 index.txt"
+    else
+        echo "TEST FAILED! ./indexer letters-10 index.txt $flags differs from ./indexer letters-10 index.txt"
+    fi
+    if ls index.txt.run* > /dev/null 2>&1
+    then
+        echo "TEST FAILED! ./indexer letters-10 index.txt $flags left runs behind"
+        rm -f index.txt.run*
+    fi
+done
 # Testing indexer with toscrape-1
 export output=$($1 ./indexer ../../shared/tse/output/toscrape-1 index.txt 2>&1)
 if [[ $1 == "" ]]
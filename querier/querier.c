@@ -26,6 +26,8 @@
 #include "pagedir.h"
 #include "file.h"
 #include "word.h"
+#include "pagestore.h"
+#include "urltable.h"
 
 /**
  * @brief node type used to sort results
@@ -47,6 +49,15 @@ typedef struct IterArg {
     int count;  // count of nodes created
     } iter_arg_t;
 
+/**
+ * @brief where the urls of matching documents are read from, first found first
+ * 
+ */
+typedef struct docUrls {
+    urltable_t *table;  // docID -> url table the indexer wrote next to the index file, or NULL
+    pagestore_t *store; // packed page store of the page directory, or NULL
+} doc_urls_t;
+
 int fileno(FILE *stream);
 
 /**
@@ -74,20 +85,22 @@ static int parseArgs(char *args[], char **pageDir, char **indexFile);
  * 
  * @param index indexer to query
  * @param pageDir pointer to char pointer to store the page directory
+ * @param urls url table and page store of pageDir, either of which may be missing
  *  * @param queryList list of words in query
  * @return int return status code
  * - 0 for failure
  * - -1 for success
  */
-static int query(index_t *index, char *pageDir, char **queryList);
+static int query(index_t *index, char *pageDir, const doc_urls_t *urls, char **queryList);
 
 /**
  * @brief helper function to reads from stdin, validates input and parses into a normalized query
  * 
  * @param index indexer to query
  * @param pageDir pointer to char pointer to store the page directory
+ * @param urls url table and page store of pageDir, either of which may be missing
  */
-static void readParse(index_t *index, char *pageDir);
+static void readParse(index_t *index, char *pageDir, const doc_urls_t *urls);
 
 /**
  * @brief helper function to prompt and read line
@@ -145,9 +158,10 @@ static void countersUnion(void *arg, const int key, const int val1);
  * 
  * @param scores counters to sort
  * @param pageDir pointer to char pointer to store the page directory
+ * @param urls url table and page store of pageDir, either of which may be missing
  * @return int 0 if on success and -1 if there is a failure
  */
-static int sortPrint(counters_t *scores, char *pageDir);
+static int sortPrint(counters_t *scores, char *pageDir, const doc_urls_t *urls);
 
 /**
  * @brief helper function to be user to iterate when sorting counter
@@ -180,6 +194,7 @@ int main(int argc, char const *argv[]) {
     char *pageDir = NULL;
     char *indexFile = NULL;
     index_t *index = NULL;
+    doc_urls_t urls = { NULL, NULL };
 
     if (parseArgs((char **) argv, &pageDir, &indexFile) == -1) {    // parse arguments into varaibles and validate them
         logMessage(5, "%s", "main: invalid arguments (", "%s", argv[1], "%s" , ", ", "%s", argv[2], "%s", ")\n");
@@ -190,12 +205,23 @@ int main(int argc, char const *argv[]) {
     index = indexLoad((char *) indexFile);  // load an index using filename provided
     if (index == NULL) goto prep_exit;  // ensure index was created
 
-    readParse(index, pageDir);
+    char *urlFile = malloc(strlen(indexFile) + sizeof(UrltableSuffix));
+    if (urlFile != NULL) {
+        sprintf(urlFile, "%s%s", indexFile, UrltableSuffix);
+        urls.table = urltableLoad(urlFile);     // mapped once: every url is then a memory lookup
+        free(urlFile);
+    }
+    if (urls.table == NULL) {   // an index written without one: read urls from the pages
+        urls.store = pagestoreOpen(pageDir, PAGESTORE_READ);  // NULL unless the crawler packed its pages
+    }
+    readParse(index, pageDir, &urls);
 
     prep_exit:  // exit prep that can be moved to from anypoint in the function to cover all bases
     if (pageDir != NULL) free(pageDir);
     if(indexFile != NULL) free(indexFile);
     if (index != NULL) indexDelete(index);
+    urltableDelete(urls.table);
+    pagestoreClose(urls.store);
     return exit_code;
 }
 
@@ -232,7 +258,7 @@ static int parseArgs(char *args[], char **pageDir, char **indexFile) {
 }
 
 /* helper function that accepts and indexer and reads queries parses them and queries the indexer */
-static int query(index_t *index, char *pageDir, char **queryList) {
+static int query(index_t *index, char *pageDir, const doc_urls_t *urls, char **queryList) {
     if (index == NULL || pageDir == NULL || queryList == NULL) {
         logMessage(1, "query: Invalid arguments\n");
         return -1;
@@ -338,7 +364,7 @@ static int query(index_t *index, char *pageDir, char **queryList) {
         counters_delete(next);
     }
 
-    sortPrint(queryResult, pageDir);    // sort and print result
+    sortPrint(queryResult, pageDir, urls);    // sort and print result
 
     prep_return:    // return prep location that can be jumped to from anywhere in the fucntion
         if (queryList != NULL) {
@@ -353,7 +379,7 @@ static int query(index_t *index, char *pageDir, char **queryList) {
 }
 
 /* helper function to reads from stdin, validates input and parses into a normalized query */
-static void readParse(index_t *index, char *pageDir) {
+static void readParse(index_t *index, char *pageDir, const doc_urls_t *urls) {
     if (index == NULL || pageDir == NULL) {
         logMessage(1, "readParse: invalid arguments\n");
         return;
@@ -397,7 +423,7 @@ static void readParse(index_t *index, char *pageDir) {
             if (list[i] != NULL) printf("%s ", list[i]);
         }
         printf("\n");
-        query(index, pageDir, list);    // run words in list as query
+        query(index, pageDir, urls, list);    // run words in list as query
         if (line != NULL) free(line);
         line = NULL;
     }
@@ -509,7 +535,7 @@ static void countersUnion(void *arg, const int key, const int val1) {
 }
 
 /* helper function to sort and print the values in a counter */
-static int sortPrint(counters_t *scores, char *pageDir) {
+static int sortPrint(counters_t *scores, char *pageDir, const doc_urls_t *urls) {
     if (scores == NULL || pageDir == NULL) { // validate arguments
     logMessage(1, "sortPrint: Invalid arguments\n");
         return -1;
@@ -523,14 +549,19 @@ static int sortPrint(counters_t *scores, char *pageDir) {
         return -1;
     }
     for (lnode_t *node = (lnode_t *) args.argNode; node != NULL; ) {    // loop and print score
-        char *url = getPageUrl(pageDir, node->values[0]);
+        const char *url = urltableGet(urls->table, node->values[0]);
+        char *read = NULL;  // url read from the page, when there is no table
+        if (urls->table == NULL) {
+            read = urls->store != NULL ? pagestoreUrl(urls->store, node->values[0]) : getPageUrl(pageDir, node->values[0]);
+            url = read;
+        }
         if (url != NULL) {
             printf("score\t%d doc %d: %s\n", node->values[1], node->values[0], url);
         }
         lnode_t *tmp = node;
         node = node->next;
         if (tmp != NULL) free(tmp);
-        if (url != NULL) free(url);
+        if (read != NULL) free(read);
     }
     return 0;
 }